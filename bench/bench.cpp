@@ -0,0 +1,109 @@
+// Microbenchmarks of the signal processing kernels at production sizes:
+// 1000-sample windows, 112 rows and 112 columns.
+//
+// Host:    pio run -e bench_native && .pio/build/bench_native/program --loops 1
+// Arduino: pio run -e bench_due -t upload && pio device monitor (renders to the panel)
+//
+// Reports ticks per call (CPU cycles on the Due, nanoseconds on the host), ns per
+// call and columns per second for every kernel.
+
+#include "signal_processor.hpp"
+#ifdef ARDUINO
+#include "display/display_st7735.hpp"
+#else
+#include "display/display_framebuffer.hpp"
+#endif
+#include "util/cycles.hpp"
+
+#define BENCH_REPS    100  // timed calls per kernel (after one warm-up call)
+#define BENCH_WINDOW  1000 // samples per A-scan window
+#define BENCH_ROWS    IMG_HEIGHT
+#define BENCH_COLS    IMG_WIDTH
+
+#ifdef ARDUINO
+DisplayST7735 display(1); // render target: the panel, a framebuffer would not fit beside the inputs
+#else
+DisplayFramebuffer display(1); // render target; also dumped by the native runner
+#endif
+
+// Inputs and outputs, kept static so that they do not count towards the stack
+static Array<float, BENCH_WINDOW>      tspan, signal;
+static Array<uint16_t, BENCH_WINDOW>   peaks_idx;
+static Array<float, BENCH_WINDOW>      peaks, amplitudes;
+static Array<float, BENCH_ROWS>        peaks_ds, env_ds, x_new, env;
+static Array<int16_t, gen::RES>        gen_raw;
+static Array<float, gen::RES>          gen_float;
+static Column                          column = col::BLACK;
+static Image                           image;
+
+/**
+ * Times fn over BENCH_REPS calls. cols is the number of A-scans a call produces,
+ * 0 for kernels below column level (columns/s is then left out).
+ */
+template <typename F>
+void bench(const __FlashStringHelper* name, const uint16_t cols, F&& fn) {
+    fn(); // warm-up: caches, first-call initialisation
+
+    uint32_t best = UINT32_MAX;
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < BENCH_REPS; i++) {
+        const uint32_t t0 = cycles::now();
+        fn();
+        const uint32_t ticks = cycles::now() - t0;
+        total += ticks;
+        if (ticks < best) best = ticks;
+    }
+
+    const uint32_t mean = total / BENCH_REPS;
+    const uint32_t ns = cycles::toNs(mean);
+    Serial << name << F("\t") << best << F("\t") << mean << F("\t") << ns;
+    if (cols > 0 && ns > 0)
+        Serial << F("\t") << (uint32_t) (1000000000ull * cols / ns);
+    Serial << endl;
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial) ;
+    cycles::begin();
+    display.init();
+    SignalProcessor::configure(BENCH_ROWS);
+
+    // Production-size window: consecutive generated frames, scaled to display units
+    while (signal.size() < BENCH_WINDOW) {
+        SignalGenerator::generateEchoes(gen_float);
+        for (uint16_t i = 0; i < gen_float.size() && !signal.full(); i++)
+            signal.push_back(gen_float[i]);
+    }
+    linspace(0, gen::TLIM, BENCH_WINDOW, tspan);
+    SignalProcessor::findPeaks(signal.view(), peaks_idx);
+    for (uint16_t i = 0; i < peaks_idx.size(); i++) {
+        peaks.push_back(tspan[peaks_idx[i]]);
+        amplitudes.push_back(signal[peaks_idx[i]]);
+    }
+    SignalProcessor::downsample(peaks.view(), BENCH_ROWS, peaks_ds);
+    SignalProcessor::downsample(amplitudes.view(), BENCH_ROWS, env_ds);
+    linspace(0, tspan.back(), BENCH_ROWS, x_new);
+
+    Serial << F("PIPELINE ") << PIPELINE << F(", ") << BENCH_REPS << F(" reps, ")
+           << cycles::TICKS_PER_US << F(" ticks/us") << endl;
+    Serial << F("kernel\tbest [ticks]\tmean [ticks]\tmean [ns]\tcolumns/s") << endl;
+
+    bench(F("linspace"), 0, [] { linspace(0, gen::TLIM, BENCH_WINDOW, tspan); });
+    bench(F("findPeaks"), 0, [] { SignalProcessor::findPeaks(signal.view(), peaks_idx); });
+    bench(F("downsample"), 0, [] { SignalProcessor::downsample(amplitudes.view(), BENCH_ROWS, env_ds); });
+    bench(F("interpLin"), 0, [] { SignalProcessor::interpLin(peaks_ds.view(), env_ds.view(), x_new.view(), env); });
+    bench(F("generateEchoes (int16)"), 0, [] { SignalGenerator::generateEchoes(gen_raw); });
+    bench(F("generateEchoes (float)"), 0, [] { SignalGenerator::generateEchoes(gen_float); });
+    bench(F("receiveAScan"), 1, [] { SignalProcessor::receiveAScan(column, BENCH_ROWS); });
+    bench(F("renderColumn"), 1, [] { display.renderColumn(0, column); });
+    bench(F("receiveBScan"), BENCH_COLS, [] { SignalProcessor::receiveBScan(image, BENCH_ROWS, BENCH_COLS); });
+
+#if PROFILING
+    // Breakdown of the pipeline stages over every call above
+    Serial << endl;
+    prof::report(Serial);
+#endif
+}
+
+void loop() {}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+// Minimal Arduino core for the host-native build ([env:native]). Only the subset
+// used by the firmware is provided; behaviour follows the Arduino Due core.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT  0x0
+#define OUTPUT 0x1
+#define LED_BUILTIN 13
+
+#define DEC 10
+#define HEX 16
+
+// Flash strings are ordinary strings on the host
+class __FlashStringHelper;
+#define F(s)    (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define pgm_read_byte(addr)  (*(const uint8_t*) (addr))
+#define pgm_read_dword(addr) (*(const uint32_t*) (addr))
+
+class String : public std::string {
+   public:
+    using std::string::string;
+    String(const std::string& s) : std::string(s) {}
+    String(const char* s = "") : std::string(s) {}
+    explicit String(long v)     : std::string(std::to_string(v)) {}
+    explicit String(int v)      : std::string(std::to_string(v)) {}
+};
+
+class Print {
+   public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buf, size_t n) {
+        size_t k = 0;
+        while (n--) k += write(*buf++);
+        return k;
+    }
+    size_t write(const char* s) { return write((const uint8_t*) s, strlen(s)); }
+
+    size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+    size_t print(const String& s)       { return write((const uint8_t*) s.c_str(), s.size()); }
+    size_t print(const char s[])        { return write(s); }
+    size_t print(char c)                { return write((uint8_t) c); }
+    size_t print(unsigned char v, int base = DEC) { return print((unsigned long) v, base); }
+    size_t print(int v, int base = DEC)           { return print((long) v, base); }
+    size_t print(unsigned int v, int base = DEC)  { return print((unsigned long) v, base); }
+    size_t print(long v, int base = DEC);
+    size_t print(unsigned long v, int base = DEC);
+    size_t print(double v, int digits = 2);
+
+    size_t println()                    { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& v)          { return print(v) + println(); }
+};
+
+class Stream : public Print {
+   protected:
+    unsigned long timeout_ = 1000; // [ms]
+
+   public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long timeout) { timeout_ = timeout; }
+    size_t readBytes(uint8_t* buf, size_t n);
+    size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*) buf, n); }
+};
+
+/**
+ * Serial port of the simulator. The programming port (Serial) writes to stdout;
+ * the native port (SerialUSB) is the master side of a pseudo-terminal whose
+ * slave path is printed on start-up, so serial_client can connect to it.
+ */
+class HardwareSerial : public Stream {
+   public:
+    explicit HardwareSerial(const bool pty) : pty_(pty) {}
+
+    void begin(unsigned long baud);
+    void end();
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t n) override;
+    using Print::write;
+    operator bool(); // whether a client is attached
+
+    const char* portName() const { return port_; }
+
+   private:
+    bool pty_;
+    int  fd_   = -1;
+    int  peek_ = -1;
+    char port_[64] = "";
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial SerialUSB;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// Function-like macros as in the Arduino core; defined last so the standard headers above are unaffected
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define round(x) ((x)>=0?(long)((x)+0.5):(long)((x)-0.5))
\ No newline at end of file
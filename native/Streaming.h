@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Streaming-style insertion operators (mikalhart/Streaming) for the host-native build
+
+template <typename T>
+inline Print& operator<<(Print& stream, const T& arg) {
+    stream.print(arg);
+    return stream;
+}
+
+enum _EndLineCode { endl };
+
+inline Print& operator<<(Print& stream, _EndLineCode) {
+    stream.println();
+    return stream;
+}
\ No newline at end of file
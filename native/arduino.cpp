@@ -0,0 +1,150 @@
+// Host implementation of the Arduino core subset declared in native/Arduino.h
+
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "Arduino.h" // last: defines the Arduino min/max/abs/round macros
+
+HardwareSerial Serial(false);
+HardwareSerial SerialUSB(true);
+
+static const auto START = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - START).count();
+}
+
+uint32_t micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - START).count();
+}
+
+void delay(uint32_t ms)             { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+// No GPIO on the host: outputs are discarded, inputs read high (pull-ups)
+void pinMode(uint8_t, uint8_t)      {}
+void digitalWrite(uint8_t, uint8_t) {}
+int  digitalRead(uint8_t)           { return HIGH; }
+
+long random(long max)               { return max <= 0 ? 0 : rand() % max; }
+long random(long min, long max)     { return min >= max ? min : min + random(max - min); }
+void randomSeed(unsigned long seed) { srand(seed); }
+
+// Print
+
+size_t Print::print(long v, int base) {
+    if (v < 0 && base == DEC) return print('-') + print((unsigned long) -v, base);
+    return print((unsigned long) v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+    char buf[8*sizeof(long) + 1];
+    char* p = buf + sizeof(buf);
+    *--p = '\0';
+    if (base < 2) base = DEC;
+    do {
+        const uint8_t d = v % base;
+        *--p = d < 10 ? '0' + d : 'A' + d - 10;
+        v /= base;
+    } while (v > 0);
+    return write(p);
+}
+
+size_t Print::print(double v, int digits) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+}
+
+// Stream
+
+size_t Stream::readBytes(uint8_t* buf, size_t n) {
+    size_t k = 0;
+    const uint32_t start = millis();
+    while (k < n && millis() - start < timeout_) {
+        const int c = read();
+        if (c >= 0) buf[k++] = c;
+        else std::this_thread::yield();
+    }
+    return k;
+}
+
+// HardwareSerial
+
+void HardwareSerial::begin(unsigned long) {
+    if (!pty_) {
+        fd_ = STDOUT_FILENO;
+        return;
+    }
+    if (fd_ >= 0) return;
+
+    // Raw, non-blocking pseudo-terminal standing in for the native USB port
+    fd_ = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd_ < 0 || grantpt(fd_) != 0 || unlockpt(fd_) != 0) {
+        perror("SerialUSB");
+        end();
+        return;
+    }
+    termios tio;
+    if (tcgetattr(fd_, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd_, TCSANOW, &tio);
+    }
+    snprintf(port_, sizeof(port_), "%s", ptsname(fd_));
+    fprintf(stderr, "SerialUSB (S2) on %s\n", port_);
+
+    // A fresh master does not report a hang-up until a slave has been opened and closed
+    const int slave = open(port_, O_RDWR | O_NOCTTY);
+    if (slave >= 0) close(slave);
+}
+
+void HardwareSerial::end() {
+    if (pty_ && fd_ >= 0) close(fd_);
+    fd_ = -1;
+}
+
+int HardwareSerial::available() {
+    if (!pty_ || fd_ < 0) return 0;
+    int n = 0;
+    if (ioctl(fd_, FIONREAD, &n) != 0) n = 0;
+    return n + (peek_ >= 0);
+}
+
+int HardwareSerial::read() {
+    if (peek_ >= 0) {
+        const int c = peek_;
+        peek_ = -1;
+        return c;
+    }
+    if (!pty_ || fd_ < 0) return -1;
+    uint8_t c;
+    return ::read(fd_, &c, 1) == 1 ? c : -1;
+}
+
+int HardwareSerial::peek() {
+    if (peek_ < 0) peek_ = read();
+    return peek_;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+    if (fd_ < 0) return 0;
+    const ssize_t k = ::write(fd_, buf, n);
+    return k < 0 ? 0 : k;
+}
+
+HardwareSerial::operator bool() {
+    if (!pty_) return fd_ >= 0;
+    if (fd_ < 0) return false;
+
+    // The master hangs up while no client holds the slave side open
+    pollfd p = {fd_, POLLIN, 0};
+    return poll(&p, 1, 0) >= 0 && !(p.revents & POLLHUP);
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Entry point of the host-native firmware build: runs the unmodified setup()/loop()
+//
+// Usage: program [--loops N] [--ppm path] [--cfg INDEX=VALUE]... [--seed S]
+//                [--dump PIPELINE COLS | --decode ENCODING N]
+//   --loops N            stop after N iterations of loop() (runs until interrupted by default)
+//   --ppm path           dump the framebuffer as a PPM image on exit
+//   --cfg INDEX=VALUE    override cfg::config_[INDEX] before starting
+//   --seed S             generator seed (GEN_SEED by default)
+//   --dump PIPELINE COLS instead of running the loop, process COLS generated A-scans with
+//                        the PIPELINE_* id and write the greyscale columns to stdout
+//   --decode ENCODING N  instead of running the loop, decode one column payload of N
+//                        samples from stdin and write them to stdout as int16 (little endian)
+//
+// --dump and --decode drive the firmware code from host-side tools (util/, serial_client/).
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Arduino.h"
+#include "signal_processor.hpp"
+#include "payload_codec.hpp"
+#include "display/display_framebuffer.hpp"
+
+void setup();
+void loop();
+
+extern DisplayFramebuffer display;
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) { running = 0; }
+
+// Runs the generator through a pipeline, one column of IMG_HEIGHT/imgScale rows per A-scan
+static int dump(const uint8_t pipeline, const unsigned long cols) {
+    const uint16_t n_rows = IMG_HEIGHT / (cfg::imgScale() > 0 ? cfg::imgScale() : 1);
+    SignalProcessor::configure(n_rows);
+    Column column = col::BLACK;
+    for (unsigned long c = 0; c < cols; c++) {
+        SignalProcessor::receiveAScanWith(pipeline, column.span(), n_rows);
+        if (fwrite(&column[0], 1, n_rows, stdout) != n_rows) return 1;
+    }
+    return 0;
+}
+
+// Decodes exactly one column; a payload that ends early or runs past it fails
+static int decode(const uint8_t encoding, const uint16_t n) {
+    codec::Decoder decoder;
+    decoder.begin(encoding, n);
+    int c;
+    while (!decoder.done() && (c = getchar()) != EOF) {
+        decoder.push(c, [](const int16_t sample) {
+            const uint8_t le[2] = {(uint8_t) sample, (uint8_t) (sample >> 8)};
+            fwrite(le, 1, 2, stdout);
+        });
+    }
+
+    if (!decoder.done()) {
+        fprintf(stderr, "payload ends before %u samples\n", n);
+        return 1;
+    }
+    if (getchar() != EOF) {
+        fprintf(stderr, "payload continues past %u samples\n", n);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned long loops = 0;
+    const char* ppm = NULL;
+    uint32_t seed = GEN_SEED;
+    enum { MODE_LOOP, MODE_DUMP, MODE_DECODE } mode = MODE_LOOP;
+    unsigned long arg1 = 0, arg2 = 0;
+    for (int i = 1; i < argc; i++) {
+        unsigned index, value;
+        if (strcmp(argv[i], "--loops") == 0 && i+1 < argc) loops = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--ppm") == 0 && i+1 < argc) ppm = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) seed = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--cfg") == 0 && i+1 < argc &&
+                 sscanf(argv[++i], "%u=%u", &index, &value) == 2 && index < cfg::N_CFG)
+            cfg::config_[index] = value;
+        else if ((strcmp(argv[i], "--dump") == 0 || strcmp(argv[i], "--decode") == 0) && i+2 < argc) {
+            mode = strcmp(argv[i], "--dump") == 0 ? MODE_DUMP : MODE_DECODE;
+            arg1 = strtoul(argv[++i], NULL, 10);
+            arg2 = strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--loops N] [--ppm path] [--cfg INDEX=VALUE]... [--seed S] "
+                            "[--dump PIPELINE COLS | --decode ENCODING N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SignalGenerator::reseed(seed);
+    if (mode == MODE_DUMP) return dump(arg1, arg2);
+    if (mode == MODE_DECODE) return decode(arg1, arg2);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    setup();
+    for (unsigned long n = 0; running && (loops == 0 || n < loops); n++)
+        loop();
+
+    if (ppm != NULL && !display.dumpPPM(ppm)) {
+        perror(ppm);
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+"""
+Runs the on-device benchmark (CMD_BENCH) over the native USB port (S2) for a set of
+pipelines and A-scan window sizes, and prints the per-stage timing breakdown.
+
+Usage: python bench_client.py [--port COM4] [--runs 200] [--pipelines 0 1 2 3]
+                              [--pts 200 500 1000] [--upload]
+"""
+
+import argparse
+import numpy as np
+import serial_client as con
+
+# Configuration sent with CMD_SETUP, in the order of serial_controller.py; the window
+# (CFG_NUM_PTS_GLOBAL, CFG_MIN_T, CFG_MAX_T) is set per benchmark
+CONFIG = [10, 1, 100, 1000, 0, 1000, 50, 1550, True, 40, 0, 0, 6, con.ENCODING_INT16, 0, 0]
+
+PIPELINES = {0: "float", 1: "fixed", 2: "fused", 3: "polyphase", con.BENCH_COMPILED: "compiled"}
+
+def test_scan(n_pts):
+    """Decaying pulse-echo train at a tenth of the sampling rate, as streamed."""
+    t = np.arange(n_pts)
+    echoes = sum(np.exp(-((t - p*n_pts)/(0.02*n_pts))**2) for p in (0.1, 0.35, 0.6, 0.8))
+    return 80 * echoes * np.sin(2*np.pi*t/10)
+
+def config(n_pts):
+    cfg = list(CONFIG)
+    cfg[3] = n_pts  # CFG_NUM_PTS_GLOBAL
+    cfg[4] = 0      # CFG_MIN_T
+    cfg[5] = n_pts  # CFG_MAX_T
+    return cfg
+
+def main():
+    parser = argparse.ArgumentParser(description="On-device pipeline benchmark")
+    parser.add_argument("--port", help="native USB port (default: detect)")
+    parser.add_argument("--runs", type=int, default=200, help="A-scans per configuration")
+    parser.add_argument("--pipelines", type=int, nargs="+", default=[con.BENCH_COMPILED],
+                        help="PIPELINE ids (0 float, 1 fixed, 2 fused, 3 polyphase)")
+    parser.add_argument("--pts", type=int, nargs="+", default=[CONFIG[5]-CONFIG[4]],
+                        help="A-scan window sizes (cfg numPtsLocal)")
+    parser.add_argument("--upload", action="store_true",
+                        help="benchmark on an uploaded A-scan instead of the built-in one")
+    args = parser.parse_args()
+
+    port = args.port or con.SerialUSB.find_port()
+    if port is None:
+        print("No device found")
+        return
+
+    def run(usb: con.SerialUSB):
+        if not usb.handshake():
+            print("Handshake failed")
+            return
+
+        print(f"{'pipeline':<10}{'pts':>6}{'total':>10}" +
+              "".join(f"{s:>18}" for s in con.BENCH_STAGES) + "   [us, mean/max]")
+        for n_pts in args.pts:
+            if not usb.setup(config(n_pts)):
+                print(f"Failed to configure {n_pts} points")
+                continue
+            data = test_scan(n_pts) if args.upload else None
+            for p in args.pipelines:
+                res = usb.bench(args.runs, pipeline=p, data=data)
+                if res is None:
+                    print(f"{PIPELINES.get(p, p):<10}{n_pts:>6}  failed")
+                    continue
+                row = f"{PIPELINES.get(p, p):<10}{n_pts:>6}{res['total']/1000:>10.1f}"
+                for s in con.BENCH_STAGES:
+                    mean, peak = res[s]
+                    row += f"{mean/1000:>9.1f}/{peak/1000:<8.1f}" if res["profiled"] else f"{'-':>18}"
+                print(row)
+
+    con.SerialUSB(port=port, config=config(args.pts[0])).connect(con_evt=run, timeout=1)
+
+if __name__ == "__main__": main()
\ No newline at end of file
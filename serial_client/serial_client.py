@@ -11,6 +11,70 @@ CMD_NACK = 2
 CMD_STREAM = 3
 CMD_RESET = 4
 CMD_SETUP = 5
+CMD_BENCH = 6
+CMD_STREAM_BATCH = 7
+
+# Batched streaming limits, as defined by the firmware (serial_server.hpp)
+STREAM_MAX_BATCH = 16 # columns per frame
+STREAM_WINDOW = 4 # unacknowledged frames
+
+BENCH_SOURCE_GENERATOR = 0
+BENCH_SOURCE_UPLOAD = 1
+BENCH_COMPILED = 0xFF # run the pipeline the firmware was built with
+BENCH_STAGES = ["acquire", "envelope", "resample", "map", "render"]
+
+# Column payload encodings, negotiated with CMD_SETUP (payload_codec.hpp)
+ENCODING_INT16 = 0 # int16 per sample, float multiplied by 100
+ENCODING_U8 = 1 # one byte per sample, clamped to [0, 255]
+ENCODING_PACKED12 = 2 # 12-bit offset binary codes, 8 per unit, two samples per 3 bytes
+ENCODING_DELTA_RLE = 3 # 7-bit deltas, zero and repeat runs, int16 literals
+CFG_ENCODING_IDX = 13 # position of the encoding in the config
+
+def pack12(codes) -> bytes:
+    """Packs 12-bit codes in pairs into 3 bytes; an odd trailing code takes 2 bytes."""
+    out = bytearray()
+    for i in range(0, len(codes)-1, 2):
+        a, b = int(codes[i]), int(codes[i+1])
+        out += bytes([a & 0xFF, (a >> 8) | (b & 0x0F) << 4, b >> 4])
+    if len(codes) % 2:
+        a = int(codes[-1])
+        out += bytes([a & 0xFF, a >> 8])
+    return bytes(out)
+
+def delta_rle(samples) -> bytes:
+    """Delta and run-length codes a column of int16 samples, starting from 0."""
+    out = bytearray()
+    prev, i, n = 0, 0, len(samples)
+    while i < n:
+        x = int(samples[i])
+        run = 1
+        while i+run < n and int(samples[i+run]) == x and run < 64: run += 1
+
+        if x == 0 and (run > 1 or prev != 0):
+            out.append(0x80 | (run-1)) # zero run
+        elif x == prev and run > 1:
+            run = min(run, 63)
+            out.append(0xC0 + run-1) # repeats of the previous sample
+        elif -64 <= x-prev < 64:
+            run = 1
+            out.append((x-prev) & 0x7F) # delta
+        else:
+            run = 1
+            out += bytes([0xFF]) + struct.pack("<h", x) # literal
+        prev = x
+        i += run
+    return bytes(out)
+
+def encode(data, encoding=ENCODING_INT16) -> bytes:
+    """Encodes a column of samples in display units for transmission."""
+    if encoding == ENCODING_U8:
+        return np.clip(np.rint(data), 0, 0xFF).astype(np.uint8).tobytes()
+    if encoding == ENCODING_PACKED12:
+        return pack12(np.clip(np.rint(np.multiply(data, 8)), -0x800, 0x7FF).astype(int) + 0x800)
+    samples = np.multiply(data, 100).astype(dtype="<i2")
+    if encoding == ENCODING_DELTA_RLE:
+        return delta_rle(samples)
+    return samples.tobytes()
 
 class SerialUSB():
 
@@ -20,6 +84,9 @@ class SerialUSB():
         self.config = config
         self.baudrate = baudrate
         self.flipdata = flipdata
+        self.encoding = ENCODING_INT16 # accepted with the last setup
+        self.seq = 0 # sequence number of the next batch frame
+        self.acked = 0 # sequence number expected to be acknowledged next
     
     def connect(self, con_evt, timeout: int = 1) -> bool:
         try:
@@ -56,10 +123,7 @@ class SerialUSB():
         # Send request to device
         self.device.write(bytes(cmd))
 
-        # Wait until there is data
-        while self.device.inWaiting() == 0: pass
-
-        # Read in what the device sent
+        # Block until the device replies or the port times out
         msg = self.device.read()
         ret = -1
         try:
@@ -88,23 +152,128 @@ class SerialUSB():
     
     def setup(self, config=None) -> bool:
         if config is None: config = self.config
-        # send config values in little endian unsigned 2-byte integers (<u2)
-        return self.__command([CMD_SETUP]) and \
-               self.__command(np.asarray(config, dtype="<u2"))
+        # send config values in little endian unsigned 2-byte integers (<u2); the device
+        # refuses encodings it does not support
+        ok = self.__command([CMD_SETUP]) and \
+             self.__command(np.asarray(config, dtype="<u2"))
+        if ok: self.encoding = config[CFG_ENCODING_IDX]
+        return ok
 
     def reset(self) -> bool:
+        # Let frames in flight complete so that the reset is not read as payload; after
+        # a rejected frame the rest of the window is rejected too, so discard the replies
+        if not self.drain():
+            self.__flush()
+        self.seq = self.acked = 0
         return self.__command([CMD_RESET])
 
+    def __flush(self):
+        """Discards replies still on their way, until the line stays quiet."""
+        prev, self.device.timeout = self.device.timeout, 0.1
+        try:
+            while self.device.read(64): pass
+        finally:
+            self.device.timeout = prev
+
     def stream(self, data) -> bool:
         if self.flipdata: data = np.flip(data)
 
-        # send data stream in little endian signed 2-byte integers (<i2)
-        # -> they represent a float value multiplied by 100 (= 2 dp)
+        # send data stream in the negotiated encoding; by default little endian signed
+        # 2-byte integers (<i2) that represent a float value multiplied by 100 (= 2 dp)
         ok = self.__command([CMD_STREAM]) and \
-             self.__command(np.multiply(data, 100).astype(dtype="<i2"))
+             self.__command(encode(data, self.encoding))
         
         return ok
     
+    def __await_ack(self) -> bool:
+        """Reads one cumulative acknowledgement of batch frames: status and sequence number."""
+        msg = self.device.read(3)
+        if len(msg) < 3:
+            print("> Batch acknowledgement timed out")
+            return False
+
+        status, seq = struct.unpack("<BH", msg)
+        if status != CMD_ACK:
+            # every frame before the one expected has been accepted
+            print(f"> Batch frame rejected, device expects frame {seq}")
+            if ((seq - self.acked) & 0xFFFF) <= self.in_flight():
+                self.acked = seq
+            return False
+
+        self.acked = (seq + 1) & 0xFFFF
+        return True
+
+    def in_flight(self) -> int:
+        return (self.seq - self.acked) & 0xFFFF
+
+    def drain(self) -> bool:
+        """Waits until every batch frame sent has been acknowledged."""
+        while self.in_flight() > 0:
+            if not self.__await_ack():
+                return False
+        return True
+
+    def stream_batched(self, columns, batch=STREAM_MAX_BATCH, window=STREAM_WINDOW) -> bool:
+        """Streams columns in frames of up to batch columns without per-column round
+        trips, keeping at most window frames unacknowledged. Columns are encoded as for
+        stream() and must hold the configured number of samples."""
+
+        frame = []
+        for col in columns:
+            frame.append(col)
+            if len(frame) < batch: continue
+            if not self.__send_frame(frame, window):
+                return False
+            frame = []
+
+        if frame and not self.__send_frame(frame, window):
+            return False
+        return self.drain()
+
+    def __send_frame(self, columns, window) -> bool:
+        # Wait for credit: the oldest frame in the window must have been acknowledged
+        while self.in_flight() >= window:
+            if not self.__await_ack():
+                return False
+
+        if self.flipdata: columns = [np.flip(c) for c in columns]
+        payload = b"".join(encode(c, self.encoding) for c in columns)
+        self.device.write(struct.pack("<BHBH", CMD_STREAM_BATCH, self.seq, len(columns), len(payload)))
+        self.device.write(payload)
+        self.seq = (self.seq + 1) & 0xFFFF
+        return True
+
+    def bench(self, runs, pipeline=BENCH_COMPILED, data=None, timeout=30):
+        """Runs a pipeline on the device, on its built-in A-scan or on the given one, and
+        returns the mean time per run and per-stage mean/max times in ns, or None."""
+
+        source = BENCH_SOURCE_GENERATOR if data is None else BENCH_SOURCE_UPLOAD
+        req = struct.pack("<BBH", pipeline, source, runs)
+        if data is not None:
+            if self.flipdata: data = np.flip(data)
+            req += encode(data, self.encoding) # as for stream()
+
+        if not (self.__command([CMD_BENCH]) and self.__command(req)):
+            return None
+
+        # the device replies once all runs are complete
+        prev, self.device.timeout = self.device.timeout, timeout
+        try:
+            head = self.device.read(9)
+            if len(head) < 9 or head[0] != CMD_ACK:
+                print(f"> Benchmark failed: {head}")
+                return None
+            _, runs, profiled, total, n = struct.unpack("<BHBIB", head)
+            stages = struct.unpack(f"<{2*n}I", self.device.read(8*n))
+        finally:
+            self.device.timeout = prev
+
+        result = {"runs": runs, "profiled": bool(profiled), "total": total}
+        for i in range(n):
+            name = BENCH_STAGES[i] if i < len(BENCH_STAGES) else f"stage{i}"
+            result[name] = (stages[2*i], stages[2*i+1])
+        return result
+
     @staticmethod
     def find_port():
         """ Get the name of the port that is connected to Arduino. """
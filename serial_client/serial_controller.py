@@ -19,6 +19,12 @@ CFG_GAIN            = 50
 CFG_SPEED_SOUND     = 1550
 CFG_BSCAN_DP        = True
 CFG_SELECT_PLANE    = 40
+CFG_TGC             = 0 # Time-gain compensation at the deepest row [dB]
+CFG_DYN_RANGE       = 0 # Log compression dynamic range [dB], 0 for linear mapping
+CFG_REF_DECAY       = 6 # Reference level decays by 2^-CFG_REF_DECAY per A-scan, 0 holds the peak
+CFG_ENCODING        = con.ENCODING_U8 # Column payload encoding; image columns are already 8-bit
+CFG_DEPTH_MIN       = 0 # Shallowest displayed depth [um]
+CFG_DEPTH_MAX       = 0 # Deepest displayed depth [um], 0 for the whole A-scan
 
 img_data = None
 
@@ -40,19 +46,14 @@ def on_connect(usb: con.SerialUSB):
         print("Failed to reset")
         return
 
-    # Stream
-    col_idx = 0
-    while True:
-        # Send bytes
-        col = img_data[:, col_idx].astype(dtype="<i2")
-        #col = np.ones(112, dtype=np.ubyte)*(col_idx % 2)*255
-        if not usb.stream(data=col):
-            print(f"Failed to send stream on column index {col_idx}. Stopping...")
-            return
+    # Stream the image repeatedly, column by column, in batch frames
+    def columns():
+        while True:
+            for col_idx in range(img_data.shape[1]):
+                yield img_data[:, col_idx].astype(dtype="<i2")
 
-        col_idx += 1
-        if (col_idx == img_data.shape[1]):
-            col_idx = 0
+    if not usb.stream_batched(columns()):
+        print(f"Failed to stream frame {usb.acked}. Stopping...")
 
 def main():
     # Load images and do some basic processing first
@@ -66,7 +67,8 @@ def main():
 
     config = [CFG_FREQUENCY, CFG_IMG_SCALE,    CFG_SAMP_RATE, CFG_NUM_PTS_GLOBAL,
               CFG_MIN_T,     CFG_MAX_T,        CFG_GAIN,      CFG_SPEED_SOUND, 
-              CFG_BSCAN_DP,  CFG_SELECT_PLANE]
+              CFG_BSCAN_DP,  CFG_SELECT_PLANE, CFG_TGC,       CFG_DYN_RANGE,
+              CFG_REF_DECAY, CFG_ENCODING,     CFG_DEPTH_MIN, CFG_DEPTH_MAX]
 
     # Find relevant port
     port = con.SerialUSB.find_port()
@@ -0,0 +1,140 @@
+"""
+Live decoder for the binary telemetry frames the firmware emits on the programming
+port (S1), see src/telemetry.hpp. Text printed on the same port is passed through.
+
+Usage: python telemetry.py [PORT | -] [--baud 115200] [--raw]
+       (- reads stdin, e.g. .pio/build/native/program | python telemetry.py -)
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+VERSION = 2
+
+FLAG_PROFILING = 0x01
+FLAG_S2 = 0x02
+
+# Mirrors prof::Zone (src/util/profiler.hpp) and cfg::config_ (src/config.hpp)
+ZONES = ["loop", "ascan", "acquire", "envelope", "resample", "tone_map", "render", "bscan"]
+CONFIG = ["freq", "img_scale", "samp_rate", "num_pts_global", "min_t", "max_t", "gain",
+          "speed_sound", "bscan_dp", "select_plane", "tgc", "dyn_range", "ref_decay", "encoding",
+          "depth_min", "depth_max"]
+
+def fletcher16(data):
+    a = b = 0
+    for x in data:
+        a = (a + x) % 0xFF
+        b = (b + a) % 0xFF
+    return (b << 8) | a
+
+def parse(payload):
+    """Decodes a frame payload into a dictionary."""
+    version, flags, seq, millis, fps, rx, nacks, timeouts, sram, scratch = \
+        struct.unpack_from("<BBHIHIHHII", payload)
+    if version != VERSION:
+        raise ValueError(f"unsupported telemetry version {version}")
+    off = struct.calcsize("<BBHIHIHHII")
+
+    n_zones = payload[off]; off += 1
+    zones = {}
+    for i in range(n_zones):
+        count, mean, peak = struct.unpack_from("<HII", payload, off)
+        off += 10
+        zones[ZONES[i] if i < len(ZONES) else f"zone{i}"] = (count, mean, peak)
+
+    n_cfg = payload[off]; off += 1
+    values = struct.unpack_from(f"<{n_cfg}H", payload, off)
+    config = {CONFIG[i] if i < len(CONFIG) else f"cfg{i}": v for i, v in enumerate(values)}
+
+    return dict(seq=seq, millis=millis, fps=fps/10, profiling=bool(flags & FLAG_PROFILING),
+                s2=bool(flags & FLAG_S2), bytes_rx=rx, nacks=nacks, timeouts=timeouts,
+                free_sram=sram, scratch_peak=scratch, zones=zones, config=config)
+
+def frames(read):
+    """Yields decoded frames and text lines from a byte source read(n)."""
+    buf = bytearray()
+    while True:
+        chunk = read(256)
+        if not chunk:
+            if buf: yield buf.decode(errors="replace")
+            return
+        buf += chunk
+
+        while True:
+            start = buf.find(SYNC)
+            # Pass through complete text lines ahead of the next frame
+            text_end = len(buf) if start < 0 else start
+            nl = buf.rfind(b"\n", 0, text_end)
+            if nl >= 0:
+                for line in buf[:nl].decode(errors="replace").splitlines():
+                    yield line
+                del buf[:nl+1]
+                continue
+            if start < 0: break
+
+            if len(buf) < start+3: break
+            n = buf[start+2]
+            if len(buf) < start+3+n+2: break
+
+            body = buf[start+2:start+3+n]
+            crc, = struct.unpack_from("<H", buf, start+3+n)
+            if crc != fletcher16(body):
+                del buf[:start+1] # false sync: resynchronise past it
+                continue
+
+            if start > 0: yield buf[:start].decode(errors="replace")
+            try:
+                yield parse(bytes(body[1:]))
+            except (ValueError, struct.error) as e:
+                yield f"[telemetry] {e}"
+            del buf[:start+3+n+2]
+
+def show(f, last):
+    """Prints one frame: link and memory status, then the per-stage timings."""
+    drop = "" if last is None or f["seq"] == (last+1) & 0xFFFF else " (frames lost)"
+    sram = f"{f['free_sram']/1024:.1f} KiB" if f["free_sram"] else "n/a"
+    print(f"#{f['seq']} t={f['millis']/1000:.1f}s fps={f['fps']:.1f} "
+          f"S2={'on' if f['s2'] else 'off'} rx={f['bytes_rx']}B nack={f['nacks']} "
+          f"timeout={f['timeouts']} free={sram} scratch={f['scratch_peak']}B{drop}")
+    if f["profiling"]:
+        for name, (count, mean, peak) in f["zones"].items():
+            if count: print(f"  {name:<9} n={count:<6} mean={mean/1000:9.1f} us  max={peak/1000:9.1f} us")
+    else:
+        print("  (profiling disabled in firmware)")
+
+def main():
+    parser = argparse.ArgumentParser(description="Tail firmware telemetry on the programming port")
+    parser.add_argument("port", nargs="?", help="serial port, or - for stdin (default: detect)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--raw", action="store_true", help="print decoded frames as dictionaries")
+    args = parser.parse_args()
+
+    if args.port == "-":
+        read = sys.stdin.buffer.raw.read
+    else:
+        import serial
+        from serial_client import SerialUSB
+        port = args.port or SerialUSB.find_port()
+        if port is None:
+            print("No device found")
+            return
+        read = serial.Serial(port=port, baudrate=args.baud, timeout=None).read
+
+    last = None
+    config = None
+    for item in frames(read):
+        if isinstance(item, str):
+            print(item)
+        elif args.raw:
+            print(item)
+        else:
+            if item["config"] != config:
+                config = item["config"]
+                print("config: " + " ".join(f"{k}={v}" for k, v in config.items()))
+            show(item, last)
+            last = item["seq"]
+        sys.stdout.flush()
+
+if __name__ == "__main__": main()
\ No newline at end of file
@@ -0,0 +1,79 @@
+"""
+Round trip of the column payload encodings: columns are encoded with the helpers in
+serial_client.py and decoded by codec::Decoder (src/payload_codec.hpp) through the
+host-native build (native/native_main.cpp, --decode).
+
+Usage: pio run -e native && python -m unittest test_payload_codec
+       (NATIVE_PROGRAM overrides the path of the native program)
+"""
+
+import os
+import subprocess
+import unittest
+import numpy as np
+import serial_client as con
+
+ROOT = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+PROGRAM = os.environ.get("NATIVE_PROGRAM", os.path.join(ROOT, ".pio", "build", "native", "program"))
+
+def decode(payload, encoding, n):
+    """Samples (1/100 units) codec::Decoder yields for exactly one column of n samples."""
+    res = subprocess.run([PROGRAM, "--decode", str(encoding), str(n)], input=payload,
+                         capture_output=True)
+    if res.returncode != 0:
+        raise AssertionError(res.stderr.decode().strip())
+    return np.frombuffer(res.stdout, dtype="<i2").tolist()
+
+def expected(data, encoding):
+    """Samples the device should receive for a column in display units."""
+    if encoding == con.ENCODING_U8:
+        return (np.clip(np.rint(data), 0, 0xFF).astype(int) * 100).tolist()
+    if encoding == con.ENCODING_PACKED12:
+        codes = np.clip(np.rint(np.multiply(data, 8)), -0x800, 0x7FF).astype(int)
+        return [int(c*100 / 8) for c in codes] # C division truncates towards zero
+    return np.multiply(data, 100).astype("<i2").tolist()
+
+@unittest.skipUnless(os.path.exists(PROGRAM), f"native program not built: {PROGRAM}")
+class PayloadCodecTest(unittest.TestCase):
+
+    def roundtrip(self, data, encoding):
+        payload = con.encode(data, encoding)
+        self.assertEqual(decode(payload, encoding, len(data)), expected(data, encoding))
+        return payload
+
+    def test_int16(self):
+        rng = np.random.default_rng(1)
+        self.roundtrip(rng.uniform(-300, 300, 200).round(2), con.ENCODING_INT16)
+
+    def test_u8(self):
+        rng = np.random.default_rng(2)
+        self.roundtrip(rng.uniform(-20, 280, 200), con.ENCODING_U8) # clamped both ends
+
+    def test_packed12(self):
+        rng = np.random.default_rng(3)
+        for n in (200, 201, 1): # an odd tail takes two bytes
+            data = rng.uniform(-300, 300, n) # clipped to the 12-bit range
+            payload = self.roundtrip(data, con.ENCODING_PACKED12)
+            self.assertEqual(len(payload), 3*(n//2) + 2*(n%2))
+
+    def test_delta_rle_runs(self):
+        # zero runs of the maximum 64 and beyond, repeat runs of the maximum 63 and beyond
+        data = [0.]*64 + [0.5]*64 + [0.]*130 + [-0.4]*200 + [0.01, 0., 0.]
+        payload = self.roundtrip(np.array(data), con.ENCODING_DELTA_RLE)
+        self.assertIn(0xBF, payload) # zero run of 64
+        self.assertIn(0xFE, payload) # repeat run of 63
+
+    def test_delta_rle_literals(self):
+        # deltas at the 7-bit limits, and literals whose bytes include the 0xFF escape
+        data = [0.63, 0., -0.64, 0., 0.64, -0.01, -2.56, 327.67, -327.68, -0.01, 1., -1.]
+        payload = self.roundtrip(np.array(data), con.ENCODING_DELTA_RLE)
+        self.assertIn(bytes([0xFF, 0xFF, 0xFF]), payload) # literal -1 after the escape
+
+    def test_delta_rle_random(self):
+        rng = np.random.default_rng(4)
+        walk = np.cumsum(rng.integers(-100, 100, 1000)) / 100
+        walk[rng.integers(0, 1000, 100)] = 0
+        self.roundtrip(walk, con.ENCODING_DELTA_RLE)
+
+if __name__ == "__main__":
+    unittest.main()
\ No newline at end of file
@@ -16,14 +16,21 @@ namespace cfg {
         static const uint16_t SPEED_SOUND    = 1550;
         static const bool     BSCAN_DP       = true;
         static const uint8_t  SELECT_PLANE   = 40;
+        static const uint8_t  TGC            = 0; // time-gain compensation at the deepest row [dB]
+        static const uint8_t  DYN_RANGE      = 0; // log compression dynamic range [dB], 0 for linear
+        static const uint8_t  REF_DECAY      = 6; // reference level decays by 2^-REF_DECAY per column, 0 holds
+        static const uint8_t  ENCODING       = 0; // column payload encoding (ENCODING_*), int16 by default
+        static const uint16_t DEPTH_MIN      = 0; // shallowest displayed depth [um]
+        static const uint16_t DEPTH_MAX      = 0; // deepest displayed depth [um], 0 for the whole A-scan
     }
 
-    static const uint8_t N_CFG = 10; // number of config params to load
+    static const uint8_t N_CFG = 16; // number of config params to load
     inline bool config_update_ = false; // scheduled update of configuration settings
     inline uint16_t config_[N_CFG] = {
         def::FREQUENCY, def::IMG_SCALE, def::SAMP_RATE, def::NUM_PTS_GLOBAL,
         def::MIN_T,     def::MAX_T,     def::GAIN,      def::SPEED_SOUND,
-        def::BSCAN_DP,  def::SELECT_PLANE,
+        def::BSCAN_DP,  def::SELECT_PLANE, def::TGC,   def::DYN_RANGE,
+        def::REF_DECAY, def::ENCODING,  def::DEPTH_MIN, def::DEPTH_MAX,
     };
 
     inline void update(uint16_t config[N_CFG]) {
@@ -46,4 +53,10 @@ namespace cfg {
     inline uint16_t speedSound()    { return config_[7]; }
     inline bool     bscanDP()       { return config_[8]; }
     inline uint8_t  selectPlane()   { return config_[9]; }
+    inline uint8_t  tgc()           { return config_[10]; }
+    inline uint8_t  dynRange()      { return config_[11]; }
+    inline uint8_t  refDecay()      { return config_[12]; }
+    inline uint8_t  encoding()      { return config_[13]; }
+    inline uint16_t depthMin()      { return config_[14]; }
+    inline uint16_t depthMax()      { return config_[15]; }
 }
\ No newline at end of file
@@ -6,18 +6,26 @@ bool Display::setup() {
     fillScreen(colorBlack());
     setTextSize(1);
 
+    // Lines scroll along the screen width; the side bars form the fixed areas
+    const uint16_t scroll_width = waterfall_ ? image_scale_*image_cols_ : 0;
+    if (waterfall_)
+        scrollArea(SIDE_WIDTH_LEFT, scroll_width, SCREEN_HEIGHT-SIDE_WIDTH_LEFT-scroll_width);
+    else
+        scrollArea(0, SCREEN_HEIGHT, 0);
+    scrollTo(waterfall_ ? SIDE_WIDTH_LEFT : 0);
+
     return renderDefault();
 }
 
-bool Display::setup(const Image scan) {
-    return setup() & renderInner(scan);
+bool Display::setup(const Image& image) {
+    return setup() & renderInner(image);
 }
 
 bool Display::renderTitle() {
     fillRect(0, 0, getWidth(), TOP_HEIGHT, colorLightGrey());
     setTextFont(fontTitle());
     setTextColor(colorBlack());
-    print(28, 0, F("Smart Pupillometer"));
+    if (!waterfall_) print(28, 0, F("Smart Pupillometer"));
 
     return true;
 }
@@ -62,6 +70,8 @@ bool Display::renderLeft() {
 bool Display::renderRight() {
     setTextFont(fontContent());
     setTextColor(colorScale());
+    fillRect(getWidth()-SIDE_WIDTH_RIGHT, TOP_HEIGHT,
+             SIDE_WIDTH_RIGHT, getHeight()-TOP_HEIGHT, colorBlack()); // remove prevs
 
     const uint8_t scalebar_start = TOP_HEIGHT  + SCALEBAR_PAD;
     const uint8_t scalebar_end   = getHeight() - SCALEBAR_PAD;
@@ -71,54 +81,58 @@ bool Display::renderRight() {
     drawFastVLine(scalebar_x_pos, scalebar_start,
                   scalebar_end - scalebar_start, colorScale());
 
-    // Scale bar tick marks with labels
-    const uint8_t scalebar_pts = SCALEBAR_TICKS + 2;
-    for (uint8_t i = 0; i < scalebar_pts; i++) {
-        // Do not display the first and last marker -> out of bounds
-        if (i != 0 && i != scalebar_pts) {
-            const uint16_t y_pos = getHeight() - i*(getHeight()-TOP_HEIGHT)/scalebar_pts;
-            const uint16_t label = i*SCALEBAR_RANGE/scalebar_pts;  // tick label in microseconds
-
-            print(scalebar_x_pos + SCALEBAR_TICK_SIZE+2, y_pos-3, label);
-            drawFastHLine(scalebar_x_pos+1, y_pos, SCALEBAR_TICK_SIZE, colorScale());
-        }
+    // Tick marks at whole millimetres, widened along 1-2-5 steps to fit the bar
+    static const uint8_t STEPS[] = {1, 2, 5};
+    const uint32_t span = scale_end_ - scale_start_;
+    uint32_t step = 1000; // [um]
+    for (uint8_t k = 1; span / step > SCALEBAR_TICKS; k++) {
+        uint32_t decade = 1000;
+        for (uint8_t d = 0; d < k/3; d++) decade *= 10;
+        step = STEPS[k%3] * decade;
+    }
+
+    // Label each tick in millimetres; the bottom row is the shallowest
+    const uint32_t first = (scale_start_ + step) / step * step; // first tick past the start
+    for (uint32_t depth = first; span > 0 && depth < scale_end_; depth += step) {
+        const uint16_t y_pos = getHeight() - (uint64_t) (depth - scale_start_) * (getHeight()-TOP_HEIGHT) / span;
+        if (y_pos-3 < TOP_HEIGHT+10 || y_pos > scalebar_end) continue; // out of bounds or under the title
+
+        print(scalebar_x_pos + SCALEBAR_TICK_SIZE+2, y_pos-3, (long) (depth / 1000));
+        drawFastHLine(scalebar_x_pos+1, y_pos, SCALEBAR_TICK_SIZE, colorScale());
     }
 
     // Scale bar title
-    print(scalebar_x_pos+3, TOP_HEIGHT, F("us"));
+    print(scalebar_x_pos+3, TOP_HEIGHT, F("mm"));
 
     return true;
 }
 
-bool Display::renderColumn(const uint16_t c,
-                           const Column scan) {
-    // Ensure column fits
-    if (c >= getWidth()) return false;
-
-    // TODO: Draw entire col at once (e.g. as a bmp/sprite)
-    
-    // Conventional rendering
-    for (uint16_t cs = 0; cs < image_scale_; cs++)
-        for (uint16_t r = 0; r < image_rows_; r++)
-            for (uint8_t rs = 0; rs < image_scale_; rs++)
-                drawPixel(SIDE_WIDTH_LEFT + image_scale_*c + cs,  // scaled, padded column
-                          TOP_HEIGHT      + image_scale_*r + rs,  // scaled, padded row
-                          grayRGB565To16(scan[image_rows_-r-1])); // inverted view
+uint16_t Display::fillLine(const ArrayView<uint8_t> scan) {
+    // In waterfall mode the title strip scrolls along, so repaint its share of the line
+    const uint16_t top = lineTop();
+    const uint16_t title = colorLightGrey();
+    for (uint16_t y = 0; y < TOP_HEIGHT - top; y++)
+        line_[y] = title;
+    uint16_t* const image = line_ + TOP_HEIGHT - top;
+
+    // Convert the column into RGB565 once, scaling rows within the line buffer
+    const uint16_t h = image_scale_*image_rows_;
+    for (uint16_t r = 0; r < image_rows_; r++) {
+        const uint16_t shade = grayRGB565To16(scan[image_rows_-r-1]); // inverted view
+        for (uint8_t rs = 0; rs < image_scale_; rs++)
+            image[image_scale_*r + rs] = shade;
+    }
 
-    return true;
+    return TOP_HEIGHT - top + h;
 }
 
-bool Display::renderInner(const Image scan) {
-    
-    bool ok = true;
+bool Display::renderColumn(const uint16_t c,
+                           const ArrayView<uint8_t> scan) {
+    return renderColumnOn(*this, c, scan);
+}
 
-    // render full image by sequentially rendering each column
-    for (uint16_t c = 0; c < image_cols_; c++) {
-        bool _ok = renderColumn(c, scan[c]);
-        if (ok) ok = _ok; // record unsuccessful commands
-    }
-    
-    return ok;
+bool Display::renderInner(const Image& image) {
+    return renderInnerOn(*this, image);
 }
 
 bool Display::clear() {
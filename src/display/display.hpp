@@ -8,8 +8,7 @@
 
 // Scalebar (Right Sidebar)
 #define SCALEBAR_PAD        4
-#define SCALEBAR_TICKS      6   // amount of markers on the right side scale bar
-#define SCALEBAR_RANGE      8   // scale bar range, divisible by (SCALEBAR_TICKS+2) [us]
+#define SCALEBAR_TICKS      7   // maximum amount of markers on the right side scale bar
 #define SCALEBAR_TICK_SIZE  3   // length of tick marks for the scale bar
 
 class Display : public ColorUtil {
@@ -17,6 +16,53 @@ class Display : public ColorUtil {
     uint8_t image_scale_;
     uint16_t image_rows_;
     uint16_t image_cols_;
+    uint16_t line_[SCREEN_WIDTH]; // RGB565 line buffer for column bursts (title strip included)
+    bool waterfall_ = false; // scroll the image instead of overwriting columns in place
+    uint32_t scale_start_ = 0; // depths of the bottom and top image rows [um]
+    uint32_t scale_end_   = 0;
+
+    // Converts a column into line_, returning the number of pixels to push from lineTop()
+    uint16_t fillLine(const ArrayView<uint8_t> scan);
+
+    uint16_t lineTop()                  { return waterfall_ ? 0 : TOP_HEIGHT; }
+    uint16_t lineX(const uint16_t c)    { return SIDE_WIDTH_LEFT + image_scale_*c; }
+    uint16_t scrollStart(const uint16_t c) { return lineX((c+1) % image_cols_); }
+
+    /**
+     * Column rendering on the primitives of d, shared by Display and DisplayBackend.
+     * With Driver = Display the primitives are dispatched virtually; with a final
+     * driver class they are bound at compile time and may be inlined.
+     */
+    template <class Driver>
+    static bool renderColumnOn(Driver& d,
+                               const uint16_t c,
+                               const ArrayView<uint8_t> scan) {
+        // Ensure column fits
+        if (c >= d.getWidth()) return false;
+
+        // Send one burst per scaled, padded screen column
+        const uint16_t len = d.fillLine(scan);
+        for (uint16_t cs = 0; cs < d.image_scale_; cs++)
+            d.pushRect(d.lineX(c) + cs, d.lineTop(), 1, len, d.line_);
+
+        // Bring the oldest column to the left edge, leaving column c rightmost
+        if (d.waterfall_) d.scrollTo(d.scrollStart(c));
+
+        return true;
+    }
+
+    template <class Driver>
+    static bool renderInnerOn(Driver& d, const Image& image) {
+        bool ok = true;
+
+        // render full image by sequentially rendering each column
+        for (uint16_t c = 0; c < d.image_cols_; c++) {
+            bool _ok = renderColumnOn(d, c, image.column(c));
+            if (ok) ok = _ok; // record unsuccessful commands
+        }
+
+        return ok;
+    }
 
    public:
     uint16_t current_col = 0;
@@ -33,10 +79,28 @@ class Display : public ColorUtil {
     uint16_t getRows()      { return image_rows_; }
     uint16_t getColumns()   { return image_cols_; }
     uint8_t getImageScale() { return image_scale_; }
+    bool isWaterfall()      { return waterfall_; }
+
+    /**
+     * Waterfall mode writes each column once and advances the hardware scroll start
+     * so the newest column is always rightmost, while the side bars stay fixed. The
+     * title strip shares the scrolled lines and is therefore drawn without text.
+     * Takes effect on the next setup().
+     */
+    void setWaterfall(const bool waterfall) { waterfall_ = waterfall; }
+
+    /**
+     * Sets the depth range [um] the image rows span, from the first to the last row,
+     * for the scale bar. Takes effect on the next renderRight().
+     */
+    void setScale(const uint32_t start, const uint32_t end) {
+        scale_start_ = start;
+        scale_end_   = end > start ? end : start;
+    }
 
     bool setup();
 
-    bool setup(const Image scan);
+    bool setup(const Image& image);
 
     bool renderTitle();
 
@@ -44,14 +108,14 @@ class Display : public ColorUtil {
 
     bool renderRight();
 
-    bool renderInner(const Image scan);
+    virtual bool renderInner(const Image& image);
     
-    bool renderColumn(const Column scan) {
+    bool renderColumn(const ArrayView<uint8_t> scan) {
         return renderColumn(current_col, scan);
     }
 
-    bool renderColumn(uint16_t col,
-                      const Column scan);
+    virtual bool renderColumn(uint16_t col,
+                              const ArrayView<uint8_t> scan);
     
     bool renderDefault() {
         return renderTitle()    // Draw heading: Title
@@ -76,7 +140,10 @@ class Display : public ColorUtil {
                  setTextColor(uint16_t c) = 0,
                  drawFastVLine(uint32_t x, uint32_t y, uint32_t h, uint32_t c) = 0,
                  drawFastHLine(uint32_t x, uint32_t y, uint32_t w, uint32_t c) = 0,
-                 drawPixel(uint32_t x, uint32_t y, uint32_t c) = 0;
+                 drawPixel(uint32_t x, uint32_t y, uint32_t c) = 0,
+                 pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* data) = 0,
+                 scrollArea(uint16_t top, uint16_t height, uint16_t bottom) = 0,
+                 scrollTo(uint16_t line) = 0;
     
     virtual uint16_t colorRed() = 0,
                      colorGreen() = 0,
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <type_traits>
+#include "display.hpp"
+
+// Resolve the hot rendering primitives at compile time (CRTP) instead of per call
+#ifndef DISPLAY_STATIC
+#define DISPLAY_STATIC true
+#endif
+
+/**
+ * Statically dispatched rendering on top of Display. Drivers derive from
+ * DisplayBackend<Driver>, which overrides column rendering to run Display's shared
+ * renderColumnOn()/renderInnerOn() on the final driver class, so the primitives are
+ * bound at compile time and may be inlined. One virtual call per column or image
+ * remains for callers holding a Display (Display::setup(), SerialStream).
+ */
+template <class Driver>
+class DisplayBackend : public Display {
+
+   public:
+    using Display::Display;
+    using Display::renderColumn; // current column
+
+    bool renderColumn(const uint16_t c,
+                      const ArrayView<uint8_t> scan) override {
+        return renderColumnOn(driver(), c, scan);
+    }
+
+    bool renderInner(const Image& image) override {
+        return renderInnerOn(driver(), image);
+    }
+
+   private:
+    Driver& driver() {
+        static_assert(std::is_final<Driver>::value, "calls bind statically on final drivers only");
+        return static_cast<Driver&>(*this);
+    }
+};
+
+#if DISPLAY_STATIC
+#define DISPLAY_BASE(Driver) DisplayBackend<Driver>
+#else
+#define DISPLAY_BASE(Driver) Display
+#endif
\ No newline at end of file
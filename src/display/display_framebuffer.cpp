@@ -0,0 +1,284 @@
+#include "display_framebuffer.hpp"
+
+#ifndef ARDUINO
+#include <cstdio>
+#endif
+
+#define FONT_WIDTH  5
+#define FONT_HEIGHT 7
+#define FONT_FIRST  ' '
+#define FONT_LAST   '~'
+
+// Classic 5x7 font, printable ASCII; one byte per column, least significant bit on top
+static const uint8_t FONT[] = {
+    0x00,0x00,0x00,0x00,0x00, 0x00,0x00,0x5F,0x00,0x00, 0x00,0x07,0x00,0x07,0x00, //  !"
+    0x14,0x7F,0x14,0x7F,0x14, 0x24,0x2A,0x7F,0x2A,0x12, 0x23,0x13,0x08,0x64,0x62, // #$%
+    0x36,0x49,0x55,0x22,0x50, 0x00,0x05,0x03,0x00,0x00, 0x00,0x1C,0x22,0x41,0x00, // &'(
+    0x00,0x41,0x22,0x1C,0x00, 0x08,0x2A,0x1C,0x2A,0x08, 0x08,0x08,0x3E,0x08,0x08, // )*+
+    0x00,0x50,0x30,0x00,0x00, 0x08,0x08,0x08,0x08,0x08, 0x00,0x60,0x60,0x00,0x00, // ,-.
+    0x20,0x10,0x08,0x04,0x02, 0x3E,0x51,0x49,0x45,0x3E, 0x00,0x42,0x7F,0x40,0x00, // /01
+    0x42,0x61,0x51,0x49,0x46, 0x21,0x41,0x45,0x4B,0x31, 0x18,0x14,0x12,0x7F,0x10, // 234
+    0x27,0x45,0x45,0x45,0x39, 0x3C,0x4A,0x49,0x49,0x30, 0x01,0x71,0x09,0x05,0x03, // 567
+    0x36,0x49,0x49,0x49,0x36, 0x06,0x49,0x49,0x29,0x1E, 0x00,0x36,0x36,0x00,0x00, // 89:
+    0x00,0x56,0x36,0x00,0x00, 0x08,0x14,0x22,0x41,0x00, 0x14,0x14,0x14,0x14,0x14, // ;<=
+    0x00,0x41,0x22,0x14,0x08, 0x02,0x01,0x51,0x09,0x06, 0x32,0x49,0x79,0x41,0x3E, // >?@
+    0x7E,0x11,0x11,0x11,0x7E, 0x7F,0x49,0x49,0x49,0x36, 0x3E,0x41,0x41,0x41,0x22, // ABC
+    0x7F,0x41,0x41,0x22,0x1C, 0x7F,0x49,0x49,0x49,0x41, 0x7F,0x09,0x09,0x01,0x01, // DEF
+    0x3E,0x41,0x41,0x51,0x32, 0x7F,0x08,0x08,0x08,0x7F, 0x00,0x41,0x7F,0x41,0x00, // GHI
+    0x20,0x40,0x41,0x3F,0x01, 0x7F,0x08,0x14,0x22,0x41, 0x7F,0x40,0x40,0x40,0x40, // JKL
+    0x7F,0x02,0x04,0x02,0x7F, 0x7F,0x04,0x08,0x10,0x7F, 0x3E,0x41,0x41,0x41,0x3E, // MNO
+    0x7F,0x09,0x09,0x09,0x06, 0x3E,0x41,0x51,0x21,0x5E, 0x7F,0x09,0x19,0x29,0x46, // PQR
+    0x46,0x49,0x49,0x49,0x31, 0x01,0x01,0x7F,0x01,0x01, 0x3F,0x40,0x40,0x40,0x3F, // STU
+    0x1F,0x20,0x40,0x20,0x1F, 0x7F,0x20,0x18,0x20,0x7F, 0x63,0x14,0x08,0x14,0x63, // VWX
+    0x03,0x04,0x78,0x04,0x03, 0x61,0x51,0x49,0x45,0x43, 0x00,0x7F,0x41,0x41,0x00, // YZ[
+    0x02,0x04,0x08,0x10,0x20, 0x00,0x41,0x41,0x7F,0x00, 0x04,0x02,0x01,0x02,0x04, // \]^
+    0x40,0x40,0x40,0x40,0x40, 0x00,0x01,0x02,0x04,0x00, 0x20,0x54,0x54,0x54,0x78, // _`a
+    0x7F,0x48,0x44,0x44,0x38, 0x38,0x44,0x44,0x44,0x20, 0x38,0x44,0x44,0x48,0x7F, // bcd
+    0x38,0x54,0x54,0x54,0x18, 0x08,0x7E,0x09,0x01,0x02, 0x08,0x14,0x54,0x54,0x3C, // efg
+    0x7F,0x08,0x04,0x04,0x78, 0x00,0x44,0x7D,0x40,0x00, 0x20,0x40,0x44,0x3D,0x00, // hij
+    0x00,0x7F,0x10,0x28,0x44, 0x00,0x41,0x7F,0x40,0x00, 0x7C,0x04,0x18,0x04,0x78, // klm
+    0x7C,0x08,0x04,0x04,0x78, 0x38,0x44,0x44,0x44,0x38, 0x7C,0x14,0x14,0x14,0x08, // nop
+    0x08,0x14,0x14,0x18,0x7C, 0x7C,0x08,0x04,0x04,0x08, 0x48,0x54,0x54,0x54,0x20, // qrs
+    0x04,0x3F,0x44,0x40,0x20, 0x3C,0x40,0x40,0x20,0x7C, 0x1C,0x20,0x40,0x20,0x1C, // tuv
+    0x3C,0x40,0x30,0x40,0x3C, 0x44,0x28,0x10,0x28,0x44, 0x0C,0x50,0x50,0x50,0x3C, // wxy
+    0x44,0x64,0x54,0x4C,0x44, 0x00,0x08,0x36,0x41,0x00, 0x00,0x00,0x7F,0x00,0x00, // z{|
+    0x00,0x41,0x36,0x08,0x00, 0x10,0x08,0x08,0x10,0x08,                           // }~
+};
+
+uint16_t DisplayFramebuffer::getHeight()                    { return height_; }
+uint16_t DisplayFramebuffer::getWidth()                     { return width_; }
+void DisplayFramebuffer::init()                             { markAll(); }
+void DisplayFramebuffer::setTextSize(uint8_t size)          { text_size_ = size; }
+void DisplayFramebuffer::setTextFont(uint8_t font)          { text_font_ = font; }
+void DisplayFramebuffer::setTextColor(uint16_t c)           { text_color_ = c; }
+void DisplayFramebuffer::fillScreen(uint16_t c)             { fillRect(0, 0, width_, height_, c); }
+void DisplayFramebuffer::drawFastVLine(uint32_t x, uint32_t y,
+                                       uint32_t h, uint32_t c)  { fillRect(x, y, 1, h, c); }
+void DisplayFramebuffer::drawFastHLine(uint32_t x, uint32_t y,
+                                       uint32_t w, uint32_t c)  { fillRect(x, y, w, 1, c); }
+void DisplayFramebuffer::drawPixel(uint32_t x, uint32_t y,
+                                   uint32_t c)              { if (x < width_ && y < height_) set(x, y, c); }
+void DisplayFramebuffer::setCursor(uint16_t x, uint16_t y,
+                                   uint8_t font) {
+    cursor_x_ = x;
+    cursor_y_ = y;
+    text_font_ = font;
+}
+
+// Odd rotations are landscape, as on the ST7735
+void DisplayFramebuffer::setRotation(uint8_t rot) {
+    width_  = rot & 1 ? SCREEN_HEIGHT : SCREEN_WIDTH;
+    height_ = rot & 1 ? SCREEN_WIDTH  : SCREEN_HEIGHT;
+    markAll();
+}
+
+void DisplayFramebuffer::fillRect(uint16_t x, uint16_t y, uint16_t w,
+                                  uint16_t h, uint16_t c) {
+    const uint16_t x_end = x+w > width_  ? width_  : x+w;
+    const uint16_t y_end = y+h > height_ ? height_ : y+h;
+    for (uint16_t j = y; j < y_end; j++)
+        for (uint16_t i = x; i < x_end; i++)
+            set(i, j, c);
+}
+
+void DisplayFramebuffer::pushRect(uint16_t x, uint16_t y, uint16_t w,
+                                  uint16_t h, const uint16_t* data) {
+    for (uint16_t j = 0; j < h && y+j < height_; j++)
+        for (uint16_t i = 0; i < w && x+i < width_; i++)
+            set(x+i, y+j, data[j*w + i]);
+}
+
+void DisplayFramebuffer::scrollArea(uint16_t top, uint16_t height, uint16_t bottom) {
+    scroll_top_    = top;
+    scroll_height_ = height;
+    scroll_bottom_ = bottom;
+    scroll_dirty_  = true;
+}
+void DisplayFramebuffer::scrollTo(uint16_t line) {
+    if (line == scroll_start_) return;
+    scroll_start_ = line;
+    scroll_dirty_ = true;
+}
+
+uint16_t DisplayFramebuffer::shown(uint16_t x, uint16_t y) {
+    // Lines within the scroll area are shown starting from scroll_start_
+    if (width_ > height_ && scroll_height_ > 0 &&
+        x >= scroll_top_ && x < scroll_top_ + scroll_height_ &&
+        scroll_start_ >= scroll_top_) {
+        x = scroll_top_ + (x - scroll_top_ + scroll_start_ - scroll_top_) % scroll_height_;
+    }
+    return at(x, y);
+}
+
+bool DisplayFramebuffer::isDirty() {
+    if (scroll_dirty_) return true;
+    for (uint8_t t = 0; t < TILES; t++)
+        if (dirty_[t]) return true;
+    return false;
+}
+
+uint32_t DisplayFramebuffer::flush(Display& target) {
+    uint32_t sent = 0;
+
+    // Merge horizontally adjacent dirty tiles into runs, one burst each
+    for (uint8_t ty = 0; ty < TILES; ty++) {
+        uint32_t row = dirty_[ty];
+        const uint16_t y = ty*FB_TILE;
+        const uint16_t h = y+FB_TILE > height_ ? height_-y : FB_TILE;
+        while (row) {
+            uint8_t t0 = 0;
+            while (!(row & (1ul << t0))) t0++;
+            uint8_t t1 = t0;
+            while (t1 < 32 && (row & (1ul << t1))) row &= ~(1ul << t1++);
+
+            const uint16_t x = t0*FB_TILE;
+            const uint16_t w = t1*FB_TILE > width_ ? width_-x : (t1-t0)*FB_TILE;
+            for (uint16_t j = 0; j < h; j++)
+                for (uint16_t i = 0; i < w; i++)
+                    scratch_[j*w + i] = at(x+i, y+j);
+            target.pushRect(x, y, w, h, scratch_);
+            sent += w*h;
+        }
+        dirty_[ty] = 0;
+    }
+
+    if (scroll_dirty_) {
+        target.scrollArea(scroll_top_, scroll_height_, scroll_bottom_);
+        target.scrollTo(scroll_start_);
+        scroll_dirty_ = false;
+    }
+
+    return sent;
+}
+
+void DisplayFramebuffer::markAll() {
+    const uint8_t tiles_x = (width_  + FB_TILE-1) / FB_TILE;
+    const uint8_t tiles_y = (height_ + FB_TILE-1) / FB_TILE;
+    for (uint8_t t = 0; t < TILES; t++)
+        dirty_[t] = t < tiles_y ? (1ul << tiles_x) - 1 : 0;
+}
+
+bool DisplayFramebuffer::dumpPPM(Print& out) {
+    out.print(F("P6\n"));
+    out.print(width_);
+    out.print(' ');
+    out.print(height_);
+    out.print(F("\n255\n"));
+
+    uint8_t rgb[3*SCREEN_HEIGHT];
+    for (uint16_t y = 0; y < height_; y++) {
+        for (uint16_t x = 0; x < width_; x++) {
+            const uint16_t c = shown(x, y);
+            rgb[3*x]   = ((c >> 8) & 0xF8) | (c >> 13);
+            rgb[3*x+1] = ((c >> 3) & 0xFC) | ((c >> 9) & 0x03);
+            rgb[3*x+2] = ((c << 3) & 0xF8) | ((c >> 2) & 0x07);
+        }
+        out.write(rgb, 3*width_);
+    }
+    return true;
+}
+
+#ifndef ARDUINO
+bool DisplayFramebuffer::dumpPPM(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) return false;
+
+    fprintf(f, "P6\n%u %u\n255\n", width_, height_);
+    for (uint16_t y = 0; y < height_; y++) {
+        for (uint16_t x = 0; x < width_; x++) {
+            const uint16_t c = shown(x, y);
+            const uint8_t rgb[3] = {
+                (uint8_t) (((c >> 8) & 0xF8) | (c >> 13)),
+                (uint8_t) (((c >> 3) & 0xFC) | ((c >> 9) & 0x03)),
+                (uint8_t) (((c << 3) & 0xF8) | ((c >> 2) & 0x07)),
+            };
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+#endif
+
+// Same RGB565 values as the TFT_eSPI palette
+uint16_t DisplayFramebuffer::colorRed()         { return 0xF800; }
+uint16_t DisplayFramebuffer::colorGreen()       { return 0x07E0; }
+uint16_t DisplayFramebuffer::colorBlack()       { return 0x0000; }
+uint16_t DisplayFramebuffer::colorWhite()       { return 0xFFFF; }
+uint16_t DisplayFramebuffer::colorLightGrey()   { return 0xD69A; }
+uint16_t DisplayFramebuffer::colorDarkGrey()    { return 0x7BEF; }
+uint16_t DisplayFramebuffer::colorScale()       { return 0xFEA0; }
+
+uint8_t DisplayFramebuffer::fontTitle()         { return 2; }
+uint8_t DisplayFramebuffer::fontContent()       { return 1; }
+
+Print* DisplayFramebuffer::out() { return NULL; }
+
+// Glyphs are drawn with a transparent background; the title font is centred in its 16 px line
+int16_t DisplayFramebuffer::drawChar(int32_t x, int32_t y, char ch) {
+    if (ch < FONT_FIRST || ch > FONT_LAST) ch = '?';
+    const uint8_t* glyph = FONT + (ch - FONT_FIRST)*FONT_WIDTH;
+    const uint8_t s = text_size_;
+    if (text_font_ == 2) y += (16 - FONT_HEIGHT*s) / 2;
+
+    for (uint8_t i = 0; i < FONT_WIDTH; i++)
+        for (uint8_t j = 0; j < FONT_HEIGHT; j++)
+            if (glyph[i] & (1 << j))
+                for (uint8_t k = 0; k < s*s; k++)
+                    drawPixel(x + i*s + k%s, y + j*s + k/s, text_color_);
+
+    return (FONT_WIDTH+1)*s;
+}
+
+int16_t DisplayFramebuffer::print(int32_t poX, int32_t poY, const __FlashStringHelper* content) {
+    return print(poX, poY, reinterpret_cast<const char *>(content));
+}
+int16_t DisplayFramebuffer::print(int32_t poX, int32_t poY, const String& content) {
+    return print(poX, poY, content.c_str());
+}
+int16_t DisplayFramebuffer::print(int32_t poX, int32_t poY, const char content[]) {
+    int16_t w = 0;
+    for (uint16_t i = 0; content[i] != '\0'; i++)
+        w += drawChar(poX + w, poY, content[i]);
+    cursor_x_ = poX + w;
+    cursor_y_ = poY;
+    return w;
+}
+int16_t DisplayFramebuffer::print(int32_t poX, int32_t poY, long content) {
+    char buf[12];
+    uint8_t i = sizeof(buf);
+    buf[--i] = '\0';
+    const bool neg = content < 0;
+    unsigned long v = neg ? -content : content;
+    do {
+        buf[--i] = '0' + v % 10;
+        v /= 10;
+    } while (v > 0);
+    if (neg) buf[--i] = '-';
+    return print(poX, poY, buf + i);
+}
+int16_t DisplayFramebuffer::printFloat(int32_t poX, int32_t poY, float f, uint8_t dp) {
+    // Out of range values are labelled as by Arduino's Print
+    if (f != f) return print(poX, poY, "nan");
+    if (f > 4294967040.f || f < -4294967040.f) return print(poX, poY, f > 3.4e38f || f < -3.4e38f ? "inf" : "ovf");
+
+    // Fixed number of decimals, rounded half away from zero
+    long scale = 1;
+    for (uint8_t i = 0; i < dp; i++) scale *= 10;
+    const bool neg = f < 0;
+    const unsigned long v = (neg ? -f : f) * scale + 0.5;
+
+    int16_t w = 0;
+    if (neg) w += print(poX, poY, "-");
+    w += print(poX + w, poY, (long) (v / scale));
+    if (dp == 0) return w;
+
+    char frac[12];
+    frac[dp+1] = '\0';
+    frac[0] = '.';
+    unsigned long r = v % scale;
+    for (uint8_t i = dp; i > 0; i--) {
+        frac[i] = '0' + r % 10;
+        r /= 10;
+    }
+    return w + print(poX + w, poY, frac);
+}
\ No newline at end of file
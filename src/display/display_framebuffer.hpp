@@ -0,0 +1,117 @@
+#pragma once
+
+#include "display_backend.hpp"
+
+// Dirty tracking granularity [px]
+#define FB_TILE 8
+
+/**
+ * Off-screen Display rendering into an in-memory RGB565 framebuffer. Writes are
+ * compared against the current contents and only changed pixels mark their tile
+ * dirty, so flush() can forward just the regions that changed to another Display
+ * (e.g. the ST7735). Text uses a small built-in 5x7 font. Hardware scrolling is
+ * emulated for landscape rotations, where lines scroll along the screen width.
+ */
+class DisplayFramebuffer final : public DISPLAY_BASE(DisplayFramebuffer) {
+
+   public:
+    static const uint16_t PIXELS = SCREEN_WIDTH*SCREEN_HEIGHT;
+    static const uint8_t  TILES  = (SCREEN_WIDTH > SCREEN_HEIGHT ? SCREEN_WIDTH : SCREEN_HEIGHT) / FB_TILE;
+
+    DisplayFramebuffer(const uint8_t image_scale = cfg::imgScale()) :
+        DISPLAY_BASE(DisplayFramebuffer)(image_scale) {
+    }
+
+    ~DisplayFramebuffer() {
+
+    }
+
+    // Colour at (x, y) in memory coordinates, ignoring the scroll offset
+    uint16_t at(uint16_t x, uint16_t y) { return fb_[y*width_ + x]; }
+
+    // Colour at (x, y) as shown on screen, after scrolling
+    uint16_t shown(uint16_t x, uint16_t y);
+
+    bool isDirty();
+
+    /**
+     * Sends all dirty regions (and a changed scroll state) to target, then marks
+     * the framebuffer clean. Returns the number of pixels sent.
+     */
+    uint32_t flush(Display& target);
+
+    // Binary PPM (P6) of the screen as shown
+    bool dumpPPM(Print& out);
+#ifndef ARDUINO
+    bool dumpPPM(const char* path);
+#endif
+
+    virtual uint16_t getHeight(),
+                     getWidth() override;
+
+    virtual void init(),
+                 setRotation(uint8_t rot),
+                 fillScreen(uint16_t c),
+                 setTextSize(uint8_t size),
+                 setTextFont(uint8_t font),
+                 fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c),
+                 setCursor(uint16_t x, uint16_t y, uint8_t font),
+                 setTextColor(uint16_t c),
+                 drawFastVLine(uint32_t x, uint32_t y, uint32_t h, uint32_t c),
+                 drawFastHLine(uint32_t x, uint32_t y, uint32_t w, uint32_t c),
+                 drawPixel(uint32_t x, uint32_t y, uint32_t c),
+                 pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* data),
+                 scrollArea(uint16_t top, uint16_t height, uint16_t bottom),
+                 scrollTo(uint16_t line) override;
+
+    virtual uint16_t colorRed(),
+                     colorGreen(),
+                     colorBlack(),
+                     colorWhite(),
+                     colorLightGrey(),
+                     colorDarkGrey(),
+                     colorScale() override;
+    virtual uint8_t  fontTitle(),
+                     fontContent() override;
+
+    virtual Print* out() override;
+
+    virtual int16_t print(int32_t, int32_t, const __FlashStringHelper*),
+                    print(int32_t, int32_t, const String&),
+                    print(int32_t, int32_t, const char[]),
+                    print(int32_t, int32_t, long),
+                    printFloat(int32_t, int32_t, float, uint8_t) override;
+
+   private:
+    uint16_t fb_[PIXELS] = {};
+    uint32_t dirty_[TILES] = {}; // one bit per tile, a word per tile row
+    uint16_t scratch_[FB_TILE*TILES*FB_TILE]; // contiguous copy of a dirty run
+
+    uint16_t width_  = SCREEN_WIDTH;
+    uint16_t height_ = SCREEN_HEIGHT;
+
+    // Emulated scrolling
+    uint16_t scroll_top_    = 0;
+    uint16_t scroll_height_ = 0;
+    uint16_t scroll_bottom_ = 0;
+    uint16_t scroll_start_  = 0;
+    bool     scroll_dirty_  = false;
+
+    // Text state
+    uint16_t text_color_ = 0xFFFF;
+    uint8_t  text_size_  = 1;
+    uint8_t  text_font_  = 1;
+    int32_t  cursor_x_   = 0;
+    int32_t  cursor_y_   = 0;
+
+    void set(uint16_t x, uint16_t y, uint16_t c) {
+        uint16_t& p = fb_[y*width_ + x];
+        if (p == c) return; // write-compare: unchanged pixels stay clean
+        p = c;
+        dirty_[y / FB_TILE] |= 1ul << (x / FB_TILE);
+    }
+
+    void markAll();
+
+    int16_t drawChar(int32_t x, int32_t y, char ch);
+};
\ No newline at end of file
@@ -19,6 +19,16 @@ void DisplayST7735::drawFastHLine(uint32_t x, uint32_t y,
 void DisplayST7735::drawPixel(uint32_t x, uint32_t y,
                               uint32_t c)                   { tft.drawPixel(x, y, c); }
 
+// The panel scrolls along its native rows, which run across the screen in landscape
+void DisplayST7735::scrollArea(uint16_t top, uint16_t height, uint16_t bottom) {
+    tft.startWrite();
+    tft.writecommand(ST7735_VSCRDEF);
+    tft.writedata(top >> 8);    tft.writedata(top);
+    tft.writedata(height >> 8); tft.writedata(height);
+    tft.writedata(bottom >> 8); tft.writedata(bottom);
+    tft.endWrite();
+}
+
 uint16_t DisplayST7735::colorRed()          { return TFT_RED; }
 uint16_t DisplayST7735::colorGreen()        { return TFT_GREEN; }
 uint16_t DisplayST7735::colorBlack()        { return TFT_BLACK; }
@@ -1,19 +1,23 @@
 #pragma once
 
 #include <TFT_eSPI.h>
-#include "display.hpp"
+#include "display_backend.hpp"
 
 #define TFT_HEIGHT  SCREEN_HEIGHT
 #define TFT_WIDTH   SCREEN_WIDTH
 #define SCALE_COLOR TFT_GOLD
 
-class DisplayST7735 : public Display {
+// ST7735 vertical scrolling commands (native orientation)
+#define ST7735_VSCRDEF  0x33 // scroll area definition
+#define ST7735_VSCRSADD 0x37 // scroll start address
+
+class DisplayST7735 final : public DISPLAY_BASE(DisplayST7735) {
 
    public:
     TFT_eSPI tft; // TFT_eSPI library controls the hardware communication
 
     DisplayST7735(const uint8_t image_scale = cfg::imgScale()) :
-        Display(image_scale),
+        DISPLAY_BASE(DisplayST7735)(image_scale),
         tft(TFT_eSPI(TFT_WIDTH, TFT_HEIGHT)) { // invoke library; pins defined in User_Setup.h
     }
 
@@ -34,7 +38,10 @@ class DisplayST7735 : public Display {
                  setTextColor(uint16_t c),
                  drawFastVLine(uint32_t x, uint32_t y, uint32_t h, uint32_t c),
                  drawFastHLine(uint32_t x, uint32_t y, uint32_t w, uint32_t c),
-                 drawPixel(uint32_t x, uint32_t y, uint32_t c) override;
+                 drawPixel(uint32_t x, uint32_t y, uint32_t c),
+                 pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* data),
+                 scrollArea(uint16_t top, uint16_t height, uint16_t bottom),
+                 scrollTo(uint16_t line) override;
 
     virtual uint16_t colorRed(),
                      colorGreen(),
@@ -53,4 +60,21 @@ class DisplayST7735 : public Display {
                     print(int32_t, int32_t, const char[]),
                     print(int32_t, int32_t, long),
                     printFloat(int32_t, int32_t, float, uint8_t) override;
-};
\ No newline at end of file
+};
+
+// Hot primitives are defined inline so that DisplayBackend can inline them
+
+// Single address window followed by one SPI burst; colours are byte-swapped on the fly
+inline void DisplayST7735::pushRect(uint16_t x, uint16_t y, uint16_t w,
+                                    uint16_t h, const uint16_t* data) {
+    tft.startWrite();
+    tft.setAddrWindow(x, y, w, h);
+    tft.pushColors(const_cast<uint16_t*>(data), (uint32_t) w*h, true);
+    tft.endWrite();
+}
+inline void DisplayST7735::scrollTo(uint16_t line) {
+    tft.startWrite();
+    tft.writecommand(ST7735_VSCRSADD);
+    tft.writedata(line >> 8);   tft.writedata(line);
+    tft.endWrite();
+}
\ No newline at end of file
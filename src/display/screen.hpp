@@ -17,17 +17,84 @@
 // Positioning (Left Sidebar)
 #define S_YPOS              120 // S1 and S2 vertical positioning
 
-using Row       = Array<uint8_t, IMG_WIDTH>;
-using Column    = Array<uint8_t, IMG_HEIGHT>;
-using Image     = Array<Column,  IMG_WIDTH>;
+using Row        = Array<uint8_t, IMG_WIDTH>;
+using Column     = Array<uint8_t, IMG_HEIGHT>;
+using ColumnSpan = ArraySpan<uint8_t>; // column written in place, e.g. within an ImageBuffer
+
+// Storage order of an ImageBuffer
+enum ImageLayout : uint8_t {
+    LAYOUT_COLUMN_MAJOR, // columns contiguous: A-scans in and out without striding
+    LAYOUT_ROW_MAJOR,    // rows contiguous: horizontal (lateral) processing
+};
+
+/**
+ * Dense W x H greyscale image in one contiguous block, without per-column bookkeeping.
+ * Columns and rows are handed out as spans onto the storage, contiguous or strided
+ * depending on the layout, so nothing is copied either way.
+ */
+template <size_t W, size_t H, ImageLayout LAYOUT = LAYOUT_COLUMN_MAJOR>
+class ImageBuffer {
+
+   public:
+    static const size_t WIDTH  = W;
+    static const size_t HEIGHT = H;
+
+    uint8_t& at(const size_t c, const size_t r)             { return px_[index(c, r)]; }
+    const uint8_t& at(const size_t c, const size_t r) const { return px_[index(c, r)]; }
+
+    ArraySpan<uint8_t> column(const size_t c) {
+        return LAYOUT == LAYOUT_COLUMN_MAJOR ? ArraySpan<uint8_t>(px_ + c*H, H)
+                                             : ArraySpan<uint8_t>(px_ + c, H, W);
+    }
+
+    ArrayView<uint8_t> column(const size_t c) const {
+        return LAYOUT == LAYOUT_COLUMN_MAJOR ? ArrayView<uint8_t>(px_ + c*H, H)
+                                             : ArrayView<uint8_t>(px_ + c, H, W);
+    }
+
+    ArraySpan<uint8_t> row(const size_t r) {
+        return LAYOUT == LAYOUT_ROW_MAJOR ? ArraySpan<uint8_t>(px_ + r*W, W)
+                                          : ArraySpan<uint8_t>(px_ + r, W, H);
+    }
+
+    ArrayView<uint8_t> row(const size_t r) const {
+        return LAYOUT == LAYOUT_ROW_MAJOR ? ArrayView<uint8_t>(px_ + r*W, W)
+                                          : ArrayView<uint8_t>(px_ + r, W, H);
+    }
+
+    void fill(const uint8_t shade) {
+        for (size_t i = 0; i < W*H; i++) px_[i] = shade;
+    }
+
+    uint8_t* data()             { return px_; }
+    const uint8_t* data() const { return px_; }
+
+    // Transposes a square image in place by swapping pixels across the diagonal
+    ImageBuffer& transpose() {
+        static_assert(W == H, "in-place transpose needs a square image");
+        for (size_t i = 0; i < W; i++)
+            for (size_t j = i+1; j < W; j++) {
+                const uint8_t t = px_[i*W + j];
+                px_[i*W + j] = px_[j*W + i];
+                px_[j*W + i] = t;
+            }
+        return *this;
+    }
+
+   private:
+    uint8_t px_[W*H];
+
+    static size_t index(const size_t c, const size_t r) {
+        return LAYOUT == LAYOUT_COLUMN_MAJOR ? c*H + r : r*W + c;
+    }
+};
+
+using Image = ImageBuffer<IMG_WIDTH, IMG_HEIGHT>;
 
 // Column
 namespace col {
     inline Column createUniform(uint8_t shade) {
-        Column col;
-        for (uint8_t r = 0; r < col.max_size(); r++)
-            col[r] = shade;
-        return col;
+        return Column(shade); // all rows, so that spans onto it cover the full height
     }
 
     static const Column BLACK = createUniform(0);   // black (empty) column
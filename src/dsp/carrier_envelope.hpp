@@ -0,0 +1,229 @@
+#pragma once
+
+#include "../util/Array.h"
+#include "../util/fixed.hpp"
+#include "../util/cx_math.hpp"
+
+// Carrier-aware envelope detectors. Both produce one envelope sample per input
+// sample in bounded time, so the result is uniformly sampled and can be resampled
+// directly instead of interpolating across an irregular peak grid.
+namespace envelope {
+
+    static const uint16_t SINE_LEN = 256; // one carrier cycle, indexed by the top phase byte
+
+    struct SineTable {
+        fx::q15_t v[SINE_LEN];
+
+        constexpr SineTable() : v() {
+            for (uint16_t i = 0; i < SINE_LEN; i++)
+                v[i] = cx::lround(cx::sin(2*cx::PI*i / SINE_LEN) * fx::Q15_MAX);
+        }
+    };
+
+    static constexpr SineTable SINE{};
+
+    /**
+     * Truncated integer square root, always 16 iterations.
+     */
+    inline uint16_t isqrt(uint32_t x) {
+        uint32_t r = 0;
+        uint32_t bit = 1ul << 30;
+        while (bit > x) bit >>= 2;
+        while (bit != 0) {
+            if (x >= r + bit) {
+                x -= r + bit;
+                r = (r >> 1) + bit;
+            } else {
+                r >>= 1;
+            }
+            bit >>= 2;
+        }
+        return r;
+    }
+
+    /**
+     * Carrier phase increment per sample as a fraction of 2^32, e.g. probe and
+     * sampling frequencies both in MHz.
+     */
+    inline uint32_t phaseIncrement(const uint32_t freq,
+                                   const uint32_t samp_rate) {
+        return samp_rate == 0 ? 0 : ((uint64_t) freq << 32) / samp_rate;
+    }
+
+    /**
+     * Runs a detector across a whole signal. The detector's group delay is removed
+     * so that out[i] describes in[i]; the tail is flushed with silence.
+     */
+    template <typename Detector, size_t N>
+    void demodulate(Detector& detector,
+                    const ArrayView<int16_t> in,
+                    Array<uint16_t, N>& out) {
+        out.clear();
+        const uint16_t delay = detector.delay();
+        for (uint16_t i = 0; i < in.size(); i++) {
+            const uint16_t e = detector.push(in[i]);
+            if (i >= delay) out.push_back(e);
+        }
+        for (uint16_t i = 0; i < delay && i < in.size(); i++)
+            out.push_back(detector.push(0));
+    }
+}
+
+/**
+ * Quadrature demodulation at the probe frequency: the signal is mixed with a
+ * numerically controlled oscillator and both baseband channels are averaged over
+ * one carrier period, which also cancels the mixing product at twice the carrier.
+ */
+class QuadratureDemodulator {
+
+   public:
+    static const uint8_t MAX_PERIOD = 64; // longest averaging window [samples]
+
+    void begin(const uint32_t phase_inc,
+               const uint16_t lim) {
+        inc_    = phase_inc;
+        lim_    = lim;
+        phase_  = 0;
+        pos_    = 0;
+        sum_i_  = 0;
+        sum_q_  = 0;
+
+        // one carrier period, bounded by the averaging buffers
+        const uint64_t period = inc_ == 0 ? MAX_PERIOD : ((1ull << 32) + inc_/2) / inc_;
+        period_ = period < 1 ? 1 : period > MAX_PERIOD ? MAX_PERIOD : period;
+
+        for (uint8_t i = 0; i < period_; i++)
+            ring_i_[i] = ring_q_[i] = 0;
+    }
+
+    uint16_t delay() const { return period_ / 2; }
+
+    uint16_t push(const int16_t x) {
+        const uint8_t idx = phase_ >> 24;
+        phase_ += inc_;
+
+        // mix down to baseband
+        const int32_t i = ((int32_t) x * envelope::SINE.v[(uint8_t) (idx + envelope::SINE_LEN/4)]) >> fx::Q15_SHIFT;
+        const int32_t q = ((int32_t) x * envelope::SINE.v[idx]) >> fx::Q15_SHIFT;
+
+        // moving average over one carrier period
+        sum_i_ += i - ring_i_[pos_];
+        sum_q_ += q - ring_q_[pos_];
+        ring_i_[pos_] = i;
+        ring_q_[pos_] = q;
+        if (++pos_ == period_) pos_ = 0;
+
+        // mixing halves the amplitude
+        const int32_t mi = sum_i_ / period_;
+        const int32_t mq = sum_q_ / period_;
+        const uint32_t mag = 2 * envelope::isqrt((uint32_t) (mi*mi) + (uint32_t) (mq*mq));
+        return mag > lim_ ? lim_ : mag;
+    }
+
+   private:
+    uint32_t inc_    = 0;
+    uint32_t phase_  = 0;
+    uint16_t lim_    = 0;
+    uint8_t  period_ = 1;
+    uint8_t  pos_    = 0;
+    int32_t  sum_i_  = 0;
+    int32_t  sum_q_  = 0;
+    int32_t  ring_i_[MAX_PERIOD];
+    int32_t  ring_q_[MAX_PERIOD];
+};
+
+/**
+ * FIR Hilbert transformer of 2K+1 taps, K odd. Only odd offsets carry a weight,
+ * 2/(pi n), tapered by a Blackman window, so a K-tap transformer costs (K+1)/2
+ * multiplies per sample.
+ */
+template <uint8_t K>
+struct HilbertTaps {
+    static const uint8_t N = (K+1) / 2;
+    fx::q15_t h[N]; // weights at offsets 1, 3, ..., K
+
+    constexpr HilbertTaps() : h() {
+        for (uint8_t i = 0; i < N; i++) {
+            const uint8_t n = 2*i + 1;
+            h[i] = cx::lround(2. / (cx::PI * n) * cx::blackman((double) n / (K+1)) * fx::Q15_MAX);
+        }
+    }
+};
+
+/**
+ * Analytic signal envelope via a short Hilbert transformer. The length is picked
+ * per configuration: lower carriers relative to the sampling rate need longer
+ * filters to stay within the transformer's pass band. The remaining ripple at the
+ * carrier is divided out so that the quadrature channel matches the in-phase one.
+ */
+class HilbertDemodulator {
+
+   public:
+    static const uint8_t MAX_K = 15;
+
+    static constexpr HilbertTaps<3>  TAPS_3{};
+    static constexpr HilbertTaps<7>  TAPS_7{};
+    static constexpr HilbertTaps<15> TAPS_15{};
+
+    /**
+     * Configures the transformer for a carrier at phase_inc (fraction of 2^32 per
+     * sample): the shortest filter with K >= fs/(2 f0) is used.
+     */
+    void begin(const uint32_t phase_inc,
+               const uint16_t lim) {
+        lim_ = lim;
+        pos_ = 0;
+
+        const uint32_t k_min = phase_inc == 0 ? MAX_K : (1ul << 31) / phase_inc;
+        if (k_min <= 3) {
+            k_ = 3;  h_ = TAPS_3.h;
+        } else if (k_min <= 7) {
+            k_ = 7;  h_ = TAPS_7.h;
+        } else {
+            k_ = 15; h_ = TAPS_15.h;
+        }
+
+        // Q15 magnitude response at the carrier: 2 sum h[n] sin(2 pi n f0/fs)
+        gain_ = 0;
+        for (uint8_t i = 0; i < (k_+1)/2; i++) {
+            const uint8_t idx = ((2*i + 1) * phase_inc) >> 24;
+            gain_ += ((int32_t) h_[i] * envelope::SINE.v[idx]) >> (fx::Q15_SHIFT-1);
+        }
+        if (gain_ <= 0) gain_ = fx::Q15_MAX;
+
+        for (uint8_t i = 0; i < 2*MAX_K+1; i++)
+            ring_[i] = 0;
+    }
+
+    uint16_t delay() const { return k_; }
+
+    uint16_t push(const int16_t x) {
+        const uint8_t len = 2*k_ + 1;
+        ring_[pos_] = x;
+        if (++pos_ == len) pos_ = 0;
+
+        // ring_[pos_] now holds the oldest sample; the centre sits k_ samples later
+        const uint8_t c = pos_ + k_ >= len ? pos_ + k_ - len : pos_ + k_;
+        int64_t acc = 0; // full-scale input may exceed 32 bits on the longest filter
+        for (uint8_t i = 0; i < (k_+1)/2; i++) {
+            const uint8_t n = 2*i + 1;
+            const uint8_t early = c >= n ? c - n : c + len - n;
+            const uint8_t late  = c + n < len ? c + n : c + n - len;
+            acc += (int32_t) h_[i] * (int32_t) (ring_[early] - ring_[late]);
+        }
+
+        const int32_t re = ring_[c];
+        const int64_t q = acc / gain_;
+        const int32_t im = q > INT16_MAX ? INT16_MAX : q < -INT16_MAX ? -INT16_MAX : q;
+        const uint32_t mag = envelope::isqrt((uint32_t) (re*re) + (uint32_t) (im*im));
+        return mag > lim_ ? lim_ : mag;
+    }
+
+   private:
+    uint16_t lim_ = 0;
+    uint8_t  k_   = 3;
+    uint8_t  pos_ = 0;
+    int32_t  gain_ = fx::Q15_MAX;
+    const fx::q15_t* h_ = TAPS_3.h;
+    int16_t  ring_[2*MAX_K+1];
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * Depth windows over an A-scan. An echo from depth d returns after t = 2d/c, so with
+ * c in m/s (= um/us) and the sampling rate f in samples per us it lies at sample
+ * 2 d f / c. A gate is resolved once per configuration; the pipelines acquire,
+ * demodulate and resample only the samples inside it.
+ */
+namespace depth {
+
+    static const uint16_t MIN_SAMPLES = 8; // narrowest gate, keeps the resamplers defined
+
+    // Samples [first, first+count) of an A-scan and the depths [um] they span
+    struct Gate {
+        uint16_t first = 0;
+        uint16_t count = 0;
+        uint32_t start = 0; // depth of the first gated sample
+        uint32_t end   = 0; // depth of the last gated sample
+
+        bool contains(const uint16_t i) const { return i >= first && i - first < count; }
+    };
+
+    // Depth [um] of sample s at rate samples per us (Q16.16) and sound speed c [m/s]
+    inline uint32_t toDepth(const uint32_t s,
+                            const uint32_t rate,
+                            const uint16_t c) {
+        return rate == 0 ? 0 : ((uint64_t) s * c << 15) / rate;
+    }
+
+    // Sample at depth d [um], rounded down, or up with ceil set
+    inline uint32_t toSample(const uint32_t d,
+                             const uint32_t rate,
+                             const uint16_t c,
+                             const bool ceil = false) {
+        if (c == 0) return 0;
+        const uint64_t num = (uint64_t) d * rate;
+        const uint64_t den = (uint64_t) c << 15;
+        return (num + (ceil ? den-1 : 0)) / den;
+    }
+
+    /**
+     * Gate over an A-scan of n samples whose first sample was taken offset samples
+     * after the pulse, at rate samples per us (Q16.16) and sound speed c [m/s]. The
+     * requested window [min_um, max_um] is clamped to the A-scan and widened to
+     * MIN_SAMPLES where possible; a max_um of 0 reaches to the end of the A-scan.
+     */
+    inline Gate gate(const uint16_t n,
+                     const uint16_t offset,
+                     const uint32_t rate,
+                     const uint16_t c,
+                     const uint32_t min_um,
+                     const uint32_t max_um) {
+        Gate g;
+        if (n == 0) return g;
+
+        const uint32_t lo = toSample(min_um, rate, c);
+        const uint32_t hi = max_um == 0 ? UINT32_MAX : toSample(max_um, rate, c, true);
+        uint32_t first = lo > offset ? lo - offset : 0;
+        uint32_t last  = hi > offset ? hi - offset : 0; // inclusive
+        if (last > n-1u) last = n-1u;
+        if (first > last) first = last;
+
+        // Widen a narrow window about its centre, within the A-scan
+        const uint16_t min_count = n < MIN_SAMPLES ? n : MIN_SAMPLES;
+        if (last - first + 1 < min_count) {
+            const uint32_t mid = (first + last) / 2;
+            first = mid < min_count/2u ? 0 : mid - min_count/2u;
+            if (first + min_count > n) first = n - min_count;
+            last = first + min_count - 1;
+        }
+
+        g.first = first;
+        g.count = last - first + 1;
+        g.start = toDepth(offset + first, rate, c);
+        g.end   = toDepth(offset + last, rate, c);
+        return g;
+    }
+}
\ No newline at end of file
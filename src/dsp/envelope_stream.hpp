@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../util/Array.h"
+#include "../util/fixed.hpp"
+
+/**
+ * Single-pass envelope stage. Samples are pushed one at a time and are clamped,
+ * checked for local maxima and linearly resampled onto the uniform row grid as
+ * soon as the next peak closes a segment. Only the previous sample, the previous
+ * peak and the output rows are kept, so no buffer scales with the window length.
+ *
+ * Unlike downsample() + interpLin(), every detected peak contributes: the peak
+ * envelope is evaluated directly at the row positions instead of first decimating
+ * the peak list by index.
+ */
+template <size_t ROWS>
+class EnvelopeStream {
+
+   private:
+    // Output grid
+    uint16_t  n_rows_ = 0;
+    uint16_t  row_    = 0; // next row to emit
+    fx::q16_t pos_    = 0; // position of the next row [samples]
+    fx::q16_t end_    = 0; // position of the last row [samples]
+    int32_t   step_   = 0; // row spacing [samples]
+    uint16_t  lim_    = 0; // vertical limitation
+
+    // Peak picking
+    uint16_t  x_      = 0; // index of the next sample
+    uint16_t  y_      = 0; // previous (clamped) sample
+    int32_t   m_      = 0; // previous derivative
+    bool      peak_   = false; // whether a segment has been opened
+    fx::q16_t peak_x_ = 0; // last peak position
+    fx::q16_t peak_y_ = 0; // last peak intensity
+
+    Array<fx::q16_t, ROWS> env_;
+
+    void advance() {
+        row_++;
+        pos_ = row_ == n_rows_-1 ? end_ : pos_ + step_; // fix last entry to the window end
+    }
+
+    void emitPeak(const uint16_t x, const uint16_t y) {
+        const fx::q16_t px = fx::toQ16(x);
+        const fx::q16_t py = fx::toQ16(y);
+
+        if (!peak_) {
+            // extrapolate the first peak towards the start of the window
+            while (row_ < n_rows_ && pos_ <= px) {
+                env_.push_back(py);
+                advance();
+            }
+            peak_ = true;
+        } else {
+            // resample the segment between the last and the current peak
+            while (row_ < n_rows_ && pos_ < px) {
+                const fx::q15_t t = fx::ratioQ15(pos_ - peak_x_, px - peak_x_);
+                env_.push_back(fx::lerpQ16(peak_y_, py, t));
+                advance();
+            }
+        }
+
+        peak_x_ = px;
+        peak_y_ = py;
+    }
+
+   public:
+    /**
+     * Starts a new A-scan resampled onto n_rows positions spanning [min, max]
+     * (Q16.16 sample positions), with samples clamped to [0, lim].
+     */
+    void begin(const uint16_t n_rows,
+               const fx::q16_t min,
+               const fx::q16_t max,
+               const uint16_t lim) {
+        n_rows_ = n_rows;
+        row_    = 0;
+        pos_    = n_rows > 1 ? min : max;
+        end_    = max < min ? min : max;
+        step_   = n_rows > 1 ? (int32_t) (end_ - min) / (n_rows-1) : 0;
+        lim_    = lim;
+        x_      = 0;
+        y_      = 0;
+        m_      = 0;
+        peak_   = false;
+        peak_x_ = 0;
+        peak_y_ = 0; // an A-scan without samples stays black instead of repeating the last peak
+        env_.clear();
+    }
+
+    void push(const int16_t sample) {
+        const uint16_t y = constrain(sample, 0, (int32_t) lim_); // disregard negatives, limit
+
+        // Detect local maxima by looking at the change in local derivative
+        const int32_t m = x_ == 0 ? 0 : (int32_t) y - y_;
+        if (m_ >= 0 && m < 0)
+            emitPeak(x_-1, y_); // change occurred post-peak; previous point is a local max
+
+        m_ = m;
+        y_ = y;
+        x_++;
+    }
+
+    /**
+     * Closes the waveform with its final sample and returns the resampled envelope.
+     */
+    const Array<fx::q16_t, ROWS>& finish() {
+        if (x_ > 0) emitPeak(x_-1, y_); // append final index to finish waveform
+
+        // extrapolate the last peak towards the end of the window
+        while (row_ < n_rows_) {
+            env_.push_back(peak_y_);
+            advance();
+        }
+
+        return env_;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../util/Array.h"
+#include "../util/fixed.hpp"
+#include "../util/cx_math.hpp"
+
+// Resampling quality: zero crossings of the windowed sinc kept on each side
+#define RESAMPLE_LOW    2
+#define RESAMPLE_MEDIUM 4
+#define RESAMPLE_HIGH   8
+
+#ifndef RESAMPLE_QUALITY
+#define RESAMPLE_QUALITY RESAMPLE_MEDIUM
+#endif
+
+/**
+ * Rational-ratio polyphase resampler mapping N_IN samples onto N_OUT rows with
+ * both end points aligned, i.e. at a ratio of L/M = (N_OUT-1)/(N_IN-1). The
+ * anti-aliasing low pass is a Blackman-windowed sinc cut off at the lower of the
+ * two Nyquist rates. Its L phases are generated by the compiler as Q15 taps, each
+ * normalised to unity DC gain, so every row costs TAPS multiply-accumulates. Where
+ * each row starts and which phase it uses are tabulated as well, as is the range of
+ * rows whose taps stay within the input.
+ */
+template <uint16_t N_IN, uint16_t N_OUT, uint8_t ZEROS = RESAMPLE_QUALITY>
+class PolyphaseDecimator {
+
+   public:
+    static constexpr uint16_t G    = cx::gcd(N_IN-1, N_OUT-1);
+    static constexpr uint16_t L    = (N_OUT-1) / G; // number of phases
+    static constexpr uint16_t M    = (N_IN-1) / G;  // input step per L rows
+    static constexpr double   FC   = L < M ? (double) L / M : 1.; // cut-off relative to input Nyquist
+    static constexpr uint16_t HALF = cx::lceil(ZEROS / FC); // taps on either side of a row
+    static constexpr uint16_t TAPS = 2*HALF;
+
+    static_assert(N_IN > 1 && N_OUT > 1, "Resampling requires at least two points");
+    static_assert(N_IN < 0x8000, "Row positions are kept in 16 bits");
+
+    struct Bank {
+        fx::q15_t h[L][TAPS];
+
+        constexpr Bank() : h() {
+            for (uint16_t p = 0; p < L; p++) {
+                // tap k sits at offset k-(HALF-1)-p/L from the row position
+                double w[TAPS] = {};
+                double sum = 0;
+                for (uint16_t k = 0; k < TAPS; k++) {
+                    const double t = k - (HALF-1) - (double) p / L;
+                    w[k] = FC * cx::sinc(FC * t) * cx::blackman(t / HALF);
+                    sum += w[k];
+                }
+
+                for (uint16_t k = 0; k < TAPS; k++) {
+                    const long q = cx::lround(w[k] / sum * (1l << fx::Q15_SHIFT));
+                    h[p][k] = q > fx::Q15_MAX ? fx::Q15_MAX : q < -fx::Q15_MAX ? -fx::Q15_MAX : q;
+                }
+            }
+        }
+    };
+
+    static constexpr Bank BANK{};
+
+    struct Steps {
+        int16_t  start[N_OUT]; // first input sample under the taps
+        uint16_t phase[N_OUT];
+        uint16_t inner_lo = N_OUT; // rows [inner_lo, inner_hi) read no replicated samples
+        uint16_t inner_hi = 0;
+
+        constexpr Steps() : start(), phase() {
+            for (uint16_t j = 0; j < N_OUT; j++) {
+                const uint32_t num = (uint32_t) j * M;
+                start[j] = (int32_t) (num / L) - (HALF-1);
+                phase[j] = num % L;
+                if (start[j] >= 0 && start[j] + TAPS-1 <= N_IN-1) {
+                    if (inner_lo == N_OUT) inner_lo = j;
+                    inner_hi = j+1;
+                }
+            }
+        }
+    };
+
+    static constexpr Steps STEPS{};
+
+    /**
+     * Resamples the first N_IN entries of x (sample units) onto N_OUT rows in Q16.16.
+     * Samples beyond either end are replicated from the nearest end point.
+     */
+    template <size_t N>
+    static void process(const ArrayView<uint16_t> x,
+                        Array<fx::q16_t, N>& y) {
+        y.clear();
+        const int32_t last = (x.size() < N_IN ? x.size() : N_IN) - 1;
+        const bool complete = last == N_IN-1; // the tabulated inner rows apply
+
+        for (uint16_t j = 0; j < N_OUT; j++) {
+            const fx::q15_t* h = BANK.h[STEPS.phase[j]];
+            const int32_t start = STEPS.start[j];
+
+            int32_t acc = 0;
+            if (complete ? j >= STEPS.inner_lo && j < STEPS.inner_hi
+                         : start >= 0 && start + TAPS-1 <= last) {
+                const uint16_t* s = &x[start];
+                for (uint16_t k = 0; k < TAPS; k++)
+                    acc += (int32_t) h[k] * s[k * x.stride()];
+            } else {
+                for (uint16_t k = 0; k < TAPS; k++) {
+                    const int32_t i = start + k;
+                    acc += (int32_t) h[k] * x[i < 0 ? 0 : i > last ? last : i];
+                }
+            }
+
+            // ringing may undershoot; Q15 sample units to Q16.16
+            y.push_back(acc <= 0 ? 0 : (fx::q16_t) acc << 1);
+        }
+    }
+};
\ No newline at end of file
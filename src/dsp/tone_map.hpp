@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../util/Array.h"
+#include "../util/fixed.hpp"
+#include "../util/profiler.hpp"
+#include "../display/screen.hpp"
+
+/**
+ * Post-envelope brightness stage: depth-dependent time-gain compensation (TGC), a
+ * decaying adaptive reference level and a precomputed envelope-to-greyscale lookup
+ * table (linear or log-compressed). Tables are rebuilt in configure() only, so a
+ * column costs one 64-bit reciprocal plus a multiply and a table read per pixel.
+ */
+template <size_t ROWS>
+class ToneMap {
+
+   public:
+    static const uint16_t LUT_SIZE   = 1024;
+    static const uint8_t  MAX_TGC_DB = 90; // keeps the Q16.16 gain within 32 bits
+
+    ToneMap() { configure(ROWS); }
+
+    /**
+     * Rebuilds the TGC curve for n_rows and the greyscale table from cfg::tgc(),
+     * cfg::dynRange() and cfg::refDecay().
+     */
+    void configure(const uint16_t n_rows) {
+        n_rows_ = n_rows > ROWS ? ROWS : n_rows;
+        decay_  = cfg::refDecay();
+
+        // TGC rises linearly in dB from the top row to cfg::tgc() at the bottom row
+        const uint8_t tgc = cfg::tgc() > MAX_TGC_DB ? MAX_TGC_DB : cfg::tgc();
+        for (uint16_t i = 0; i < n_rows_; i++) {
+            const float db = n_rows_ < 2 ? 0 : (float) tgc * i / (n_rows_-1);
+            tgc_[i] = pow(10., db/20.) * fx::Q16_ONE;
+        }
+
+        // Linear ramp, or 20 log10 compression onto cfg::dynRange() dB below the reference
+        const uint8_t dr = cfg::dynRange();
+        lut_[0] = 0;
+        for (uint16_t i = 1; i < LUT_SIZE; i++) {
+            const float x = (float) i / (LUT_SIZE-1);
+            const float y = dr == 0 ? x : 1. + 20.*log10(x)/dr;
+            lut_[i] = y <= 0 ? 0 : y >= 1 ? 0xFF : (uint8_t) (y*0xFF + 0.5);
+        }
+    }
+
+    /**
+     * Maps a Q16.16 envelope onto a greyscale column. The reference follows the
+     * brightest compensated sample and otherwise decays by 2^-refDecay per column.
+     */
+    void map(const ArrayView<fx::q16_t> env,
+             const ColumnSpan col) {
+        PROFILE(ZONE_TONE_MAP);
+        uint16_t n_rows = env.size() < n_rows_ ? env.size() : n_rows_;
+        if (n_rows > col.size()) n_rows = col.size();
+
+        // Apply TGC and track the column maximum (the first row is disregarded)
+        fx::q16_t col_max = 0;
+        for (uint16_t i = 0; i < n_rows; i++) {
+            const uint64_t e = ((uint64_t) env[i] * tgc_[i]) >> fx::Q16_SHIFT;
+            comp_[i] = e > UINT32_MAX ? UINT32_MAX : e;
+            if (i > 0 && comp_[i] > col_max) col_max = comp_[i];
+        }
+
+        if (decay_ > 0) ref_ -= ref_ >> decay_;
+        if (col_max > ref_) ref_ = col_max;
+
+        // Normalise into the table index range; samples above the reference (only
+        // ever the disregarded first row) saturate rather than overflow the product
+        const uint64_t scale = ref_ == 0 ? 0 : ((uint64_t) (LUT_SIZE-1) << 32) / ref_;
+        col.fill(0); // greyscale format
+        for (uint16_t i = 0; i < n_rows; i++) {
+            const fx::q16_t c = comp_[i] > ref_ ? ref_ : comp_[i];
+            const uint64_t idx = (c * scale + (1ull << 31)) >> 32;
+            col[i] = lut_[idx >= LUT_SIZE ? LUT_SIZE-1 : idx];
+        }
+    }
+
+    fx::q16_t reference() const { return ref_; }
+
+   private:
+    uint16_t  n_rows_ = ROWS;
+    uint8_t   decay_  = 0;
+    fx::q16_t ref_    = 0; // adaptive reference level
+    fx::q16_t tgc_[ROWS];  // per-row gain, Q16.16
+    fx::q16_t comp_[ROWS]; // compensated envelope
+    uint8_t   lut_[LUT_SIZE];
+};
\ No newline at end of file
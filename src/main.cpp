@@ -6,13 +6,24 @@
 
 // Includes
 #include "signal_processor.hpp"
+#ifdef ARDUINO
 #include "display/display_st7735.hpp"
-#include "util/timer.hpp"
+#endif
+#include "display/display_framebuffer.hpp"
+#include "util/cycles.hpp"
+#include "util/profiler.hpp"
+#include "util/scheduler.hpp"
+#include "util/running_stats.hpp"
 #include "serial_server.hpp"
+#include "telemetry.hpp"
 
 // Loggers and debuggers
 #define DEBUG false    // keep false unless debugging
 
+// Rendering
+#define WATERFALL false // scroll the B-scan continuously instead of overwriting in place
+#define FRAMEBUFFER false // render off-screen and flush only the dirty regions to the panel
+
 // SPI TFT Display Pins
                         // TFT 1 Vcc -> Arduino Due +3.3V - Power
                         // TFT 2 GND -> Arduino Due GND - Ground
@@ -40,109 +51,257 @@
 #define FPS_BUFFER_LEN 30
 #define FPS_UPDATE_INTERVAL_MS 500
 
+// Scheduling
+#define COLUMN_INTERVAL_MS     0     // minimum spacing of A-scans; 0 processes them as they arrive
+#define COLUMN_BUDGET_US       40000 // A-scan processing counted as an overrun beyond this
+#define CONNECTION_INTERVAL_MS 1000
+
 // Variables for internal use
+#ifndef ARDUINO
+DisplayFramebuffer display(cfg::imgScale()); // host-native build: off-screen only
+#elif FRAMEBUFFER
+DisplayFramebuffer display(cfg::imgScale()); // off-screen render target
+DisplayST7735 panel(cfg::imgScale()); // TFT ST7735, receives dirty regions only
+#else
 DisplayST7735 display(cfg::imgScale()); // create TFT ST7735 display instance
+#endif
 uint16_t total_cols = display.getColumns();
 
 // Serial communication manager
 SerialStream usb(&display);
+#if TELEMETRY
+Telemetry telemetry;
+#endif
 
-// Scanning timing
-Timer scan_timer;
-uint16_t scan_time = 0;
-uint16_t scan_time_n = 0;
+Column scan = col::BLACK; // most recent A-scan, rendered in place
 
 // FPS Monitor
-Timer fps_timer;
-Array<float, FPS_BUFFER_LEN> fps_buf;
-uint32_t fps_last_update = millis();
+stats::Window<float, FPS_BUFFER_LEN> fps_win; // column rate over the last frames
+float fps_avg = 0; // last value shown on the sidebar
+uint32_t fps_last_col = micros(); // time the previous column was rendered
+stats::Window<uint32_t, FPS_BUFFER_LEN> scan_us; // A-scan processing times
+
+// Cooperative tasks, listed in priority order
+enum Task : uint8_t {
+    TASK_INGEST,      // serial reception; releases the event tasks
+    TASK_CONTROL,     // config updates and benchmarks requested through the port
+    TASK_RENDER,      // column transfer to the display
+    TASK_DSP,         // A-scan acquisition and processing
+    TASK_UI,          // sidebar refresh
+    TASK_TELEMETRY,   // status frames on S1
+    TASK_CONNECTIONS, // serial connectivity
+    TASK_FLUSH,       // framebuffer to panel
+    N_TASKS
+};
+Scheduler<N_TASKS> sched;
 
 /**
- * Initialisation
+ * Runs a benchmark scheduled through CMD_BENCH: the requested pipeline on the chosen
+ * test A-scan, rendered at the current column, with the time of each stage taken
+ * from the profiler zones. The result is sent back on the native port.
  */
-void setup() {
-    // Configure pins
-    pinMode(LED_BUILTIN, OUTPUT);
-    pinMode(PIN_OUT_PULSE, OUTPUT);
-    pinMode(PIN_IN_PULSE, INPUT);
-    pinMode(PIN_IN_MAGNITUDE, INPUT);
-    pinMode(PIN_IN_SLEEP, INPUT);
-    
-    // Set up Serials
-    Serial.begin(115200);
-    SerialUSB.begin(115200);
-    usb.checkConnections(false); // do premature checking in case startup messages to be printed
+void runBench(const BenchRequest& req) {
+    BenchResult res;
+    res.runs = req.runs;
+    SerialStream* source = req.source == BENCH_SOURCE_UPLOAD ? &usb : NULL;
 
-    // Set up display screen
-    display.setup();
+#if PROFILING
+    prof::reset();
+#endif
+    usb.replay(source != NULL);
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < req.runs; i++) {
+        const uint32_t start = cycles::now();
+        SignalProcessor::receiveAScanWith(req.pipeline, scan, display.getRows(), source);
+        {
+            PROFILE(ZONE_RENDER);
+            display.renderColumn(scan);
+        }
+        total += cycles::now() - start;
+    }
+    usb.replay(false);
+    res.total_ns = cycles::toNs(total / req.runs);
+
+#if PROFILING
+    static const prof::Zone STAGES[BENCH_STAGES] = {
+        prof::ZONE_ACQUIRE, prof::ZONE_ENVELOPE, prof::ZONE_RESAMPLE,
+        prof::ZONE_TONE_MAP, prof::ZONE_RENDER
+    };
+    res.profiled = true;
+    for (uint8_t i = 0; i < BENCH_STAGES; i++) {
+        const prof::Stats& s = prof::stats(STAGES[i]);
+        res.mean_ns[i] = cycles::toNs(s.total / req.runs);
+        res.max_ns[i]  = cycles::toNs(s.max);
+    }
+    prof::reset(); // keep the benchmark out of the running statistics
+#endif
+
+    usb.finishBench(res);
 }
 
 /**
- * Main tick
+ * Moves what has arrived on the native port through the parser and releases the
+ * tasks waiting on it. Runs on every tick.
  */
-void loop() {
-    // Time loop
-    fps_timer.start();
+void ingest() {
+    usb.poll();
+    if (cfg::scheduledUpdate() || usb.scheduledBench()) sched.signal(TASK_CONTROL);
+
+    // Process the next A-scan once it has arrived, or generate one while unconnected
+    if (!usb.s2() || usb.columnReady()) sched.signal(TASK_DSP);
+}
+
+// Labels the scale bar with the depths gated from the current A-scan source
+void updateScale() {
+    const depth::Gate& gate = SignalProcessor::gate(usb.s2());
+    display.setScale(gate.start, gate.end);
+    display.renderRight();
+    sched.signal(TASK_FLUSH);
+}
 
+void control() {
     // Check if config is scheduled to update through port
     if (cfg::scheduledUpdate()) {
         // TODO: Update image scaling in display manually
+        SignalProcessor::configure(display.getRows()); // rebuild brightness tables and depth gates
         display.renderLeft(); // update config display
-        display.renderRight(); // update time scope
+        updateScale(); // update depth scope
 
         cfg::finishUpdate();
+        sched.signal(TASK_FLUSH);
     }
-    
-    // Actively listen for changes in serial connectivity
-    usb.checkConnections(true);
 
+    // Run a benchmark requested through the port, in between A-scans
+    if (usb.scheduledBench()) runBench(usb.benchRequest());
+}
+
+void dsp() {
     // Disable signal retrieval while paused
     //while (digitalRead(PIN_IN_SLEEP) == LOW) ;
 
-    scan_timer.start(); // start timer
     // Generate AScan from ultrasound data stream or otherwise
-    Column scan = SignalProcessor::receiveAScan(display.getRows(), &usb);
-    display.renderColumn(scan); // render on hardware screen at current column
-    scan_time += scan_timer.stop(); // stop timer and save
-    scan_time_n++;
+    const uint32_t start = cycles::now();
+    SignalProcessor::receiveAScan(scan, display.getRows(), &usb);
+    scan_us.add(cycles::toNs(cycles::now() - start) / 1000);
+    sched.signal(TASK_RENDER);
+}
 
-    // Average out timer and output progress
-    if (display.current_col == 0) {
-        scan_time = 0;
-        scan_time_n = 0;
+void render() {
+    {
+        PROFILE(ZONE_RENDER);
+        display.renderColumn(scan); // render on hardware screen at current column
+    }
+
+    // Output progress, and the zone and task timings once per sweep
 #if DEBUG
+    if (display.current_col == 0) {
         Serial << F("Rendering ") << total_cols << F(" scans.") << endl;
+    } else if (display.current_col+1 == total_cols) {
+        Serial << F("Rendered ") << total_cols << F(" scans. A-scan: ");
+        Serial.print(scan_us.mean(), 1);
+        Serial << F(" +/- ");
+        Serial.print(scan_us.stddev(), 1);
+        Serial << F(" us (") << scan_us.minimum() << F("-") << scan_us.maximum() << F("), scratch peak ")
+               << scratch::arena.peak() << F("/") << scratch::arena.capacity() << F(" B") << endl;
+#if PROFILING && !TELEMETRY // telemetry owns the statistics otherwise
+        prof::report(Serial);
+        prof::reset();
 #endif
-    } else if ((display.current_col+1) % round(total_cols/5) == 0 ||  // progress
-                display.current_col+1 == total_cols) {                // end
-#if DEBUG
-        Serial << F("Rendered ") << current_col+1 << F("/") << total_cols << F(" scans (")
-               << 100*(current_col+1)/total_cols << F("%) in ") << scan_time
-               << F(" ms (~") << scan_time/scan_time_n << F(" ms/scan).") << endl;
-#endif
-        scan_time = 0;
-        scan_time_n = 0;
+        sched.report(Serial);
+        sched.reset();
     }
+#endif
 
     if (++display.current_col == total_cols) {
         display.current_col = 0;
         //display.clearInner(); // clear when new data comes in
     }
 
-    // Record FPS
-    float hz = 1./((float) fps_timer.stop() / 1000.); // parse elapsed ms to fps
-    if (fps_buf.full()) fps_buf.remove(0); // discard element at front if full
-    fps_buf.push_back(hz); // append
-    uint32_t now = millis();
-    if (now - fps_last_update > FPS_UPDATE_INTERVAL_MS) {
-        // update average FPS counter on sidebar
-        fps_last_update = now;
-        float tot = 0;
-        for (uint8_t i = 0; i < fps_buf.size(); i++)
-            tot += fps_buf[i];
-        float avg = tot / (float) fps_buf.size();
-        display.fillRect(0, 110, SIDE_WIDTH_LEFT, 10, display.colorBlack());
-        display.setTextColor(display.colorWhite());
-        display.printFloat(0, 110, avg, 1);
-    }
+    // Record FPS as the rate at which columns reach the screen
+    const uint32_t now = micros();
+    const uint32_t us = now - fps_last_col;
+    fps_last_col = now;
+    float hz = us == 0 ? 0 : 1e6/us; // parse elapsed us to fps
+    fps_win.add(hz);
+    sched.signal(TASK_FLUSH);
+}
+
+void ui() {
+    if (fps_win.empty()) return;
+
+    // update average FPS counter on sidebar
+    fps_avg = fps_win.mean();
+    display.fillRect(0, 110, SIDE_WIDTH_LEFT, 10, display.colorBlack());
+    display.setTextColor(display.colorWhite());
+    display.printFloat(0, 110, fps_avg, 1);
+    sched.signal(TASK_FLUSH);
+}
+
+#if TELEMETRY
+void sendTelemetry() { telemetry.update(usb, fps_avg); } // per-stage status on S1
+#endif
+
+// Actively listen for changes in serial connectivity
+void connections() {
+    const bool s2 = usb.s2();
+    usb.checkConnections(true);
+    if (usb.s2() != s2) updateScale(); // streamed and generated A-scans are gated apart
+}
+
+#if defined(ARDUINO) && FRAMEBUFFER
+void flush() { display.flush(panel); } // send what changed since the last flush
+#endif
+
+/**
+ * Initialisation
+ */
+void setup() {
+    // Configure pins
+    pinMode(LED_BUILTIN, OUTPUT);
+    pinMode(PIN_OUT_PULSE, OUTPUT);
+    pinMode(PIN_IN_PULSE, INPUT);
+    pinMode(PIN_IN_MAGNITUDE, INPUT);
+    pinMode(PIN_IN_SLEEP, INPUT);
+    
+    cycles::begin(); // time base for the FPS counter and profiler
+
+    // Set up Serials
+    Serial.begin(115200);
+    SerialUSB.begin(115200);
+    usb.checkConnections(false); // do premature checking in case startup messages to be printed
+
+    // Set up display screen
+#if defined(ARDUINO) && FRAMEBUFFER
+    panel.init();
+    panel.setRotation(1);
+#endif
+    display.setWaterfall(WATERFALL);
+    display.setup();
+    SignalProcessor::configure(display.getRows());
+    updateScale();
+
+    // Register tasks: id, name, function, kind, priority, period (ms), budget (us)
+    using S = Scheduler<N_TASKS>;
+    sched.add(TASK_INGEST, "ingest", ingest, S::TASK_PERIODIC, TASK_INGEST, 0);
+    sched.add(TASK_CONTROL, "control", control, S::TASK_EVENT, TASK_CONTROL, 0);
+    sched.add(TASK_RENDER, "render", render, S::TASK_EVENT, TASK_RENDER, 0);
+    sched.add(TASK_DSP, "dsp", dsp, S::TASK_EVENT, TASK_DSP, COLUMN_INTERVAL_MS, COLUMN_BUDGET_US);
+    sched.add(TASK_UI, "ui", ui, S::TASK_PERIODIC, TASK_UI, FPS_UPDATE_INTERVAL_MS);
+#if TELEMETRY
+    sched.add(TASK_TELEMETRY, "telemetry", sendTelemetry, S::TASK_PERIODIC, TASK_TELEMETRY,
+              TELEMETRY_INTERVAL_MS);
+#endif
+    sched.add(TASK_CONNECTIONS, "connections", connections, S::TASK_PERIODIC, TASK_CONNECTIONS,
+              CONNECTION_INTERVAL_MS);
+#if defined(ARDUINO) && FRAMEBUFFER
+    sched.add(TASK_FLUSH, "flush", flush, S::TASK_EVENT, TASK_FLUSH, 0);
+#endif
+}
+
+/**
+ * Main tick
+ */
+void loop() {
+    PROFILE(ZONE_LOOP);
+    sched.tick();
 }
\ No newline at end of file
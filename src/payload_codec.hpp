@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Column payload encodings, negotiated through CMD_SETUP (cfg::encoding())
+#define ENCODING_INT16     0 // little endian int16 per sample, in 1/100 units
+#define ENCODING_U8        1 // one byte per sample, pre-clamped to [0, 0xFF] units
+#define ENCODING_PACKED12  2 // 12-bit offset binary ADC codes, two samples per 3 bytes
+#define ENCODING_DELTA_RLE 3 // 7-bit deltas, zero and repeat runs, int16 literals
+#define N_ENCODINGS        4
+
+#define PACKED12_ZERO      0x800 // ADC code of a zero sample
+#define PACKED12_PER_UNIT  8     // ADC codes per display unit
+
+/**
+ * Byte-at-a-time decoding of a column payload into samples in the transmitted units
+ * (1/100), the format every pipeline consumes. Encodings:
+ *
+ *  ENCODING_PACKED12: sample pairs a, b as a[7:0], b[3:0] a[11:8], b[11:4]; an odd
+ *  trailing sample takes two bytes, a[7:0] and a[11:8].
+ *
+ *  ENCODING_DELTA_RLE: each column starts from 0 and consists of tags
+ *      0x00-0x7F  previous sample plus a signed 7-bit delta
+ *      0x80-0xBF  (tag & 0x3F)+1 zero samples
+ *      0xC0-0xFE  (tag - 0xC0)+1 repeats of the previous sample
+ *      0xFF       literal: the next two bytes are the sample, little endian
+ *  Runs never cross a column boundary.
+ */
+namespace codec {
+
+    // Payload size of a column of n samples, 0 for variable-size encodings
+    inline uint32_t columnBytes(const uint8_t encoding, const uint16_t n) {
+        switch (encoding) {
+            case ENCODING_INT16:    return 2ul*n;
+            case ENCODING_U8:       return n;
+            case ENCODING_PACKED12: return 3ul*(n/2) + 2*(n%2);
+            default:                return 0;
+        }
+    }
+
+    // Largest payload of a column of n samples
+    inline uint32_t maxColumnBytes(const uint8_t encoding, const uint16_t n) {
+        return encoding == ENCODING_DELTA_RLE ? 3ul*n : columnBytes(encoding, n);
+    }
+
+    class Decoder {
+
+       public:
+        void begin(const uint8_t encoding, const uint16_t n) {
+            encoding_ = encoding;
+            left_     = n;
+            state_    = 0;
+            acc_      = 0;
+            prev_     = 0;
+        }
+
+        bool done() const { return left_ == 0; }
+
+        /**
+         * Consumes one payload byte, handing any completed samples to sink.
+         */
+        template <typename Sink>
+        void push(const uint8_t b, Sink&& sink) {
+            switch (encoding_) {
+                case ENCODING_U8:
+                    emit(b * 100, sink);
+                    break;
+                case ENCODING_PACKED12:
+                    pushPacked12(b, sink);
+                    break;
+                case ENCODING_DELTA_RLE:
+                    pushDeltaRLE(b, sink);
+                    break;
+                default: // ENCODING_INT16
+                    if (state_ == 0) {
+                        acc_ = b;
+                        state_ = 1;
+                    } else {
+                        emit((int16_t) (acc_ | b << 8), sink);
+                        state_ = 0;
+                    }
+                    break;
+            }
+        }
+
+       private:
+        uint8_t  encoding_ = ENCODING_INT16;
+        uint16_t left_     = 0; // samples still to be decoded
+        uint8_t  state_    = 0; // bytes into the current group or literal
+        uint16_t acc_      = 0; // bits of a sample split across bytes
+        int16_t  prev_     = 0; // last sample, for deltas and repeats
+
+        template <typename Sink>
+        void emit(const int16_t sample, Sink& sink) {
+            if (left_ == 0) return; // malformed payload: overlong run
+            left_--;
+            prev_ = sample;
+            sink(sample);
+        }
+
+        template <typename Sink>
+        void emitPacked12(const uint16_t code, Sink& sink) {
+            emit(((int16_t) code - PACKED12_ZERO) * 100 / PACKED12_PER_UNIT, sink);
+        }
+
+        template <typename Sink>
+        void pushPacked12(const uint8_t b, Sink& sink) {
+            switch (state_) {
+                case 0:
+                    acc_ = b;
+                    state_ = 1;
+                    break;
+                case 1:
+                    emitPacked12(acc_ | (b & 0x0F) << 8, sink);
+                    acc_ = b >> 4;
+                    state_ = left_ > 0 ? 2 : 0; // an odd trailing sample ends here
+                    break;
+                default:
+                    emitPacked12(acc_ | b << 4, sink);
+                    state_ = 0;
+                    break;
+            }
+        }
+
+        template <typename Sink>
+        void pushDeltaRLE(const uint8_t b, Sink& sink) {
+            // Literal in progress
+            if (state_ == 1) {
+                acc_ = b;
+                state_ = 2;
+                return;
+            }
+            if (state_ == 2) {
+                emit((int16_t) (acc_ | b << 8), sink);
+                state_ = 0;
+                return;
+            }
+
+            if (b < 0x80) {
+                const int8_t delta = (int8_t) (b << 1) >> 1; // sign extend 7 bits
+                emit(prev_ + delta, sink);
+            } else if (b < 0xC0) {
+                for (uint8_t i = 0; i <= (b & 0x3F); i++) emit(0, sink);
+            } else if (b < 0xFF) {
+                const int16_t v = prev_;
+                for (uint8_t i = 0; i <= b - 0xC0; i++) emit(v, sink);
+            } else {
+                state_ = 1;
+            }
+        }
+    };
+}
\ No newline at end of file
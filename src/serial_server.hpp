@@ -1,6 +1,8 @@
 #pragma once
 
 #include "display/display.hpp"
+#include "payload_codec.hpp"
+#include "util/RingArray.h"
 
 #define CMD_HANDSHAKE 0
 #define CMD_ACK       1
@@ -8,130 +10,456 @@
 #define CMD_STREAM    3
 #define CMD_RESET     4
 #define CMD_SETUP     5
+#define CMD_BENCH     6
+#define CMD_STREAM_BATCH 7
 
 #define STATUS_NOT_SETUP 10
 #define STATUS_STANDBY   11
 #define STATUS_BUSY      12
 
 #define ALLOCATE_TASK_MILLIS 1000
+#define SERIAL_RING_SIZE     1024 // bytes received ahead of the parser
+
+// Batched streaming (CMD_STREAM_BATCH): columns per frame and unacknowledged frames
+#define STREAM_MAX_BATCH 16
+#define STREAM_WINDOW    4
+
+#define BENCH_SOURCE_GENERATOR 0 // built-in synthetic A-scan
+#define BENCH_SOURCE_UPLOAD    1 // A-scan of cfg::numPtsLocal() samples sent along with CMD_BENCH
+#define BENCH_COMPILED         0xFF // pipeline id selecting the compiled PIPELINE
+#define BENCH_STAGES           5 // acquire, envelope, resample, map, render
+
+// Benchmark requested through CMD_BENCH, run by the main loop
+struct BenchRequest {
+    uint8_t  pipeline = BENCH_COMPILED; // PIPELINE_* id
+    uint8_t  source   = BENCH_SOURCE_GENERATOR;
+    uint16_t runs     = 0;
+};
+
+// Timings of a benchmark in ns; means are per run, maxima per single stage entry
+struct BenchResult {
+    uint16_t runs = 0;
+    bool     profiled = false; // stage breakdown available (PROFILING)
+    uint32_t total_ns = 0;
+    uint32_t mean_ns[BENCH_STAGES] = {};
+    uint32_t max_ns[BENCH_STAGES]  = {};
+};
 
 class SerialStream {
 
    private:
 
+    // Parser states: what the next byte from the native port belongs to
+    enum State : uint8_t {
+        STATE_COMMAND,    // command byte
+        STATE_SETUP,      // config values of CMD_SETUP
+        STATE_BENCH,      // request of CMD_BENCH
+        STATE_BATCH_HEAD, // header of CMD_STREAM_BATCH
+        STATE_COLUMN,     // column payload of CMD_STREAM, CMD_STREAM_BATCH or CMD_BENCH
+        STATE_DISCARD,    // payload of a rejected batch frame
+        STATE_EXCESS,     // payload beyond the columns of an accepted batch frame
+    };
+
+    // Command a column payload belongs to, which decides where it goes and the reply
+    enum Origin : uint8_t {
+        ORIGIN_STREAM,
+        ORIGIN_BATCH,
+        ORIGIN_BENCH,
+    };
+
+    using Scan = Array<int16_t, cfg::def::MAX_T-cfg::def::MIN_T>;
+
     // USB ports
-    uint32_t port_update_ = millis(); // last update time: used for caching
-    uint8_t  status_      = STATUS_NOT_SETUP; // device functionality status
-    bool     port_prg_    = false; // programming serial port: debug messages and general outputting
-    bool     port_usb_    = false; // native serial port: listen for stream and simple outputting
+    uint8_t  status_   = STATUS_NOT_SETUP; // device functionality status
+    bool     port_prg_ = false; // programming serial port: debug messages and general outputting
+    bool     port_usb_ = false; // native serial port: listen for stream and simple outputting
 
     // Stream properties
     bool raw_signal_ = true; // whether or not to listen for unprocessed signal (raw float values)
 
-    // unions used for transmission of data size across stream of larger than 1 byte
-    union u16 {
-        byte b[2];
-        uint16_t val;
-    } u16;
+    // Link statistics since start-up, reported through telemetry
+    uint32_t bytes_rx_ = 0; // bytes read from the native port
+    uint16_t nacks_    = 0; // negative acknowledgements sent
+    uint16_t timeouts_ = 0; // commands abandoned after ALLOCATE_TASK_MILLIS without data
 
-    union i16 {
-        byte b[2];
-        int16_t val;
-    } i16;
+    // Incremental parser, fed from a ring that the native port is drained into
+    RingArray<uint8_t, SERIAL_RING_SIZE> ring_;
+    State    state_    = STATE_COMMAND;
+    Origin   origin_   = ORIGIN_STREAM;
+    uint16_t count_    = 0; // bytes of the current state read so far, or left to discard
+    uint32_t last_rx_  = 0; // time the current command last made progress
+    byte     field_[2*cfg::N_CFG]; // config, request or header bytes being assembled
+    bool     col_open_ = false; // a column is being decoded
+    codec::Decoder decoder_; // column payload in the negotiated encoding
 
-    bool toc(uint32_t tic) {
-        return millis() - tic > ALLOCATE_TASK_MILLIS;
+    // Double-buffered columns: one slot is filled while the other is processed
+    Scan    slots_[2];
+    uint8_t slot_read_   = 0; // oldest complete column
+    uint8_t slots_ready_ = 0; // complete columns not yet delivered
+
+    // Batch frame being parsed
+    uint16_t batch_seq_  = 0; // sequence number of the current frame
+    uint16_t next_seq_   = 0; // sequence number expected next
+    uint8_t  batch_cols_ = 0; // columns of the current frame not yet parsed
+    uint16_t batch_left_ = 0; // payload bytes of the current frame not yet parsed
+
+    // Scheduled benchmark and its uploaded test A-scan
+    BenchRequest bench_;
+    bool bench_ok_      = false; // request valid, pending its upload
+    bool bench_pending_ = false;
+    bool replay_        = false; // deliver the test A-scan instead of received columns
+    Scan bench_scan_;
+
+    void reply(const uint8_t response) {
+        if (response == CMD_NACK) nacks_++;
+        SerialUSB.write(response);
     }
-    
-   public:
-    Display* display_; // hardware display screen
 
-    SerialStream(Display* display) :
-        display_(display) {}
-    
-    template <size_t N>
-    Array<float, N> listen() {
-        Array<float, N> arr;
-        arr.assign(cfg::numPtsLocal(), 0);
-
-        if (port_usb_ && SerialUSB.available()) {
-            uint8_t cmd = SerialUSB.read();
-
-            // deny command if busy
-            if (status_ == STATUS_BUSY) {
-                SerialUSB.write(CMD_NACK);
-                return arr;
-            }
+    // Writes the n low bytes of v, least significant first
+    void write(const uint32_t v, const uint8_t n) {
+        for (uint8_t i = 0; i < n; i++)
+            SerialUSB.write((uint8_t) (v >> (8*i)));
+    }
 
-            // process command otherwise
-            uint32_t tic = millis(); // record task start time for timeout
-            switch (cmd) {
-                case CMD_HANDSHAKE: {
-                    SerialUSB.write(CMD_ACK); // return pong
-                    break;
-                } case CMD_SETUP: {
-                    SerialUSB.write(CMD_ACK); // acknowledge command
-                    digitalWrite(LED_BUILTIN, HIGH); // turn on LED during setup processing
-                    while (!SerialUSB.available()) if (toc(tic)) return arr; // await stream
-
-                    // populate config array with transmitted 2-byte data, assembled
-                    // into unsigned 16-bit integers via LSB (little endianess)
-                    uint16_t cfg[cfg::N_CFG] = {}; // based on the amount of expected config params
-                    uint8_t i = 0;
-                    for (; i < cfg::N_CFG; i++) {
-                        SerialUSB.readBytes(u16.b, 2);
-                        cfg[i] = u16.val;
-                    }
-                    cfg::update(cfg); // schedule config update
-
-                    // finish
-                    SerialUSB.write(i == cfg::N_CFG ? CMD_ACK : CMD_NACK); // response
-                    digitalWrite(LED_BUILTIN, LOW); // turn off LED during standby
-                    status_ = STATUS_STANDBY; // enable accepting data streams
-                    break;
-                } case CMD_STREAM: {
-                    // only stream when in standby
-                    if (status_ != STATUS_STANDBY) {
-                        SerialUSB.write(CMD_NACK);
-                        break;
-                    }
-
-                    SerialUSB.write(CMD_ACK); // acknowledge command
-                    digitalWrite(LED_BUILTIN, HIGH); // turn on LED during stream processing
-                    while (!SerialUSB.available()) if (toc(tic)) return arr; // await stream
-                    // populate data stream with transmitted 2-byte floats multiplied by 100
-                    // and assembled into unsigned 16-bit integers via LSB (little endianess)
-                    uint16_t i = 0;
-                    for (; i < cfg::numPtsLocal(); i++) {
-                        SerialUSB.readBytes(i16.b, 2);
-                        arr.push_back((float) i16.val / 100.);
-                    }
-
-                    // finish
-                    SerialUSB.write(i == cfg::numPtsLocal() ? CMD_ACK : CMD_NACK);
-                    digitalWrite(LED_BUILTIN, LOW); // turn off LED during standby
-                    break;
-                } case CMD_RESET: {
-                    display_->current_col = 0; // reset column counter
-                    display_->clearInner(); // reset view
-                    SerialUSB.write(CMD_ACK);
+    uint16_t field16(const uint8_t i) const { return field_[i] | field_[i+1] << 8; }
+
+    uint8_t fillSlot() const { return (slot_read_ + slots_ready_) & 1; }
+
+    // Destination of the column being decoded
+    Scan& target() { return origin_ == ORIGIN_BENCH ? bench_scan_ : slots_[fillSlot()]; }
+
+    // A new column must wait until the consumer frees a slot
+    bool stalled() const {
+        return state_ == STATE_COLUMN && origin_ != ORIGIN_BENCH && !col_open_ && slots_ready_ == 2;
+    }
+
+    void enter(const State state) {
+        state_ = state;
+        count_ = 0;
+    }
+
+    void nackBatch() {
+        reply(CMD_NACK);
+        write(next_seq_, 2);
+    }
+
+    // Acknowledges the current frame and all before it with its sequence number
+    void ackBatch() {
+        reply(CMD_ACK);
+        write(batch_seq_, 2);
+    }
+
+    // Answers the command in progress negatively and returns to command parsing
+    void abort() {
+        const bool batch = state_ == STATE_BATCH_HEAD || state_ == STATE_DISCARD || state_ == STATE_EXCESS ||
+                           (state_ == STATE_COLUMN && origin_ == ORIGIN_BATCH);
+        if (batch) nackBatch();
+        else reply(CMD_NACK);
+
+        col_open_   = false;
+        batch_cols_ = 0;
+        digitalWrite(LED_BUILTIN, LOW);
+        enter(STATE_COMMAND);
+    }
+
+    void parse(const uint8_t b) {
+        switch (state_) {
+            case STATE_COMMAND:
+                command(b);
+                break;
+            case STATE_SETUP:
+                field_[count_++] = b;
+                if (count_ == 2*cfg::N_CFG) parseSetup();
+                break;
+            case STATE_BENCH:
+                field_[count_++] = b;
+                if (count_ == 4) parseBench();
+                break;
+            case STATE_BATCH_HEAD:
+                field_[count_++] = b;
+                if (count_ == 5) parseBatchHead();
+                break;
+            case STATE_DISCARD:
+                if (--count_ > 0) break;
+                nackBatch();
+                enter(STATE_COMMAND);
+                break;
+            case STATE_EXCESS:
+                if (--count_ > 0) break;
+                ackBatch();
+                enter(STATE_COMMAND);
+                break;
+            case STATE_COLUMN:
+                parseColumn(b);
+                break;
+        }
+    }
+
+    void command(const uint8_t cmd) {
+        // deny command if busy; a batch frame is parsed regardless, so that its
+        // header and payload are rejected as a whole rather than read as commands
+        if (status_ == STATUS_BUSY && cmd != CMD_STREAM_BATCH) {
+            reply(CMD_NACK);
+            return;
+        }
+
+        switch (cmd) {
+            case CMD_HANDSHAKE: {
+                reply(CMD_ACK); // return pong
+                break;
+            } case CMD_SETUP: {
+                reply(CMD_ACK); // acknowledge command
+                digitalWrite(LED_BUILTIN, HIGH); // turn on LED during setup processing
+                enter(STATE_SETUP);
+                break;
+            } case CMD_STREAM: {
+                // only stream when in standby
+                if (status_ != STATUS_STANDBY) {
+                    reply(CMD_NACK);
                     break;
-                } default: {
-                    // return NACK - unrecognised command
-                    SerialUSB.write(CMD_NACK);
+                }
+
+                reply(CMD_ACK); // acknowledge command
+                digitalWrite(LED_BUILTIN, HIGH); // turn on LED during stream processing
+                origin_ = ORIGIN_STREAM;
+                enter(STATE_COLUMN);
+                break;
+            } case CMD_BENCH: {
+                // needs the window configured through CMD_SETUP
+                if (status_ != STATUS_STANDBY) {
+                    reply(CMD_NACK);
                     break;
                 }
+
+                reply(CMD_ACK); // acknowledge command
+                enter(STATE_BENCH);
+                break;
+            } case CMD_STREAM_BATCH: {
+                enter(STATE_BATCH_HEAD); // validated once complete
+                break;
+            } case CMD_RESET: {
+                // Restart the batch sequence and drop columns not yet processed; the
+                // host drains its window first, so no frame is in progress here
+                next_seq_ = 0;
+                slots_ready_ = 0;
+                display_->current_col = 0; // reset column counter
+                display_->clearInner(); // reset view
+                reply(CMD_ACK);
+                break;
+            } default: {
+                // return NACK - unrecognised command
+                reply(CMD_NACK);
+                break;
             }
         }
+    }
+
+    void parseSetup() {
+        // populate config array with transmitted 2-byte data, assembled
+        // into unsigned 16-bit integers via LSB (little endianess)
+        uint16_t cfg[cfg::N_CFG] = {}; // based on the amount of expected config params
+        for (uint8_t i = 0; i < cfg::N_CFG; i++)
+            cfg[i] = field16(2*i);
 
-        return arr;
+        // the payload encoding is negotiated here: unknown ones are refused
+        const bool ok = cfg[13] < N_ENCODINGS;
+        if (ok) cfg::update(cfg); // schedule config update
+
+        // finish
+        reply(ok ? CMD_ACK : CMD_NACK); // response
+        digitalWrite(LED_BUILTIN, LOW); // turn off LED during standby
+        status_ = STATUS_STANDBY; // enable accepting data streams
+        enter(STATE_COMMAND);
     }
 
-    void checkConnections(const bool update_display = false) {
-        // Handle check only once in a while
-        if (millis() - port_update_ < 1000) return;
-        port_update_ = millis();
+    void parseBench() {
+        // pipeline id (1), source (1) and number of runs (2)
+        bench_.pipeline = field_[0];
+        bench_.source   = field_[1];
+        bench_.runs     = field16(2);
+        bench_ok_ = bench_.runs > 0 && bench_.source <= BENCH_SOURCE_UPLOAD;
+
+        if (bench_.source == BENCH_SOURCE_UPLOAD) {
+            // test A-scan follows as for CMD_STREAM, kept for replay
+            origin_ = ORIGIN_BENCH;
+            enter(STATE_COLUMN);
+        } else {
+            scheduleBench(bench_ok_);
+        }
+    }
 
+    void scheduleBench(const bool ok) {
+        // the result follows once the main loop has run it
+        reply(ok ? CMD_ACK : CMD_NACK);
+        if (ok) {
+            bench_pending_ = true;
+            status_ = STATUS_BUSY;
+        }
+        enter(STATE_COMMAND);
+    }
+
+    void parseBatchHead() {
+        // Frame without per-column handshakes: sequence number (2), number of
+        // columns (1) and payload length in bytes (2), followed by the payload
+        // of cfg::numPtsLocal() samples per column in the negotiated encoding,
+        // exactly sized unless variable-length. Up to STREAM_WINDOW frames
+        // may be in flight; a rejected frame is answered with CMD_NACK and
+        // the sequence number expected.
+        const uint16_t seq    = field16(0);
+        const uint8_t  n_cols = field_[2];
+        const uint16_t len    = field16(3);
+
+        const uint32_t size = codec::columnBytes(cfg::encoding(), cfg::numPtsLocal());
+        const uint32_t max  = codec::maxColumnBytes(cfg::encoding(), cfg::numPtsLocal());
+        if (status_ != STATUS_STANDBY || seq != next_seq_ || n_cols == 0 ||
+                n_cols > STREAM_MAX_BATCH || len < n_cols || len > n_cols * max ||
+                (size > 0 && len != n_cols * size)) {
+            if (len == 0) {
+                nackBatch();
+                enter(STATE_COMMAND);
+            } else {
+                enter(STATE_DISCARD); // keep the byte stream in sync
+                count_ = len;
+            }
+            return;
+        }
+
+        batch_seq_  = seq;
+        batch_cols_ = n_cols;
+        batch_left_ = len;
+        origin_     = ORIGIN_BATCH;
+        enter(STATE_COLUMN);
+    }
+
+    void parseColumn(const uint8_t b) {
+        Scan& scan = target();
+        if (!col_open_) {
+            scan.clear();
+            decoder_.begin(cfg::encoding(), cfg::numPtsLocal());
+            col_open_ = true;
+        }
+
+        decoder_.push(b, [&scan](const int16_t sample) {
+            if (!scan.full()) scan.push_back(sample);
+        });
+        if (origin_ == ORIGIN_BATCH) batch_left_--;
+
+        if (decoder_.done()) {
+            col_open_ = false;
+            completeColumn();
+        } else if (origin_ == ORIGIN_BATCH && batch_left_ == 0) {
+            abort(); // frame payload ends mid-column
+        }
+    }
+
+    void completeColumn() {
+        switch (origin_) {
+            case ORIGIN_BENCH:
+                scheduleBench(bench_ok_ && bench_scan_.size() == cfg::numPtsLocal());
+                break;
+            case ORIGIN_STREAM:
+                slots_ready_++;
+                reply(CMD_ACK);
+                digitalWrite(LED_BUILTIN, LOW); // turn off LED during standby
+                enter(STATE_COMMAND);
+                break;
+            case ORIGIN_BATCH:
+                slots_ready_++;
+                if (--batch_cols_ > 0) break; // next column of the frame follows
+
+                // Every column has been queued, so the frame is accepted even if its
+                // payload is overlong; the excess is skipped before acknowledging
+                next_seq_ = batch_seq_ + 1;
+                if (batch_left_ > 0) {
+                    enter(STATE_EXCESS);
+                    count_ = batch_left_;
+                } else {
+                    ackBatch();
+                    enter(STATE_COMMAND);
+                }
+                break;
+        }
+    }
+
+   public:
+    Display* display_; // hardware display screen
+
+    SerialStream(Display* display) :
+        display_(display) {}
+
+    /**
+     * Drains the native port into the ring. Never blocks; the producer side of the
+     * ring, so it may equally be called from an interrupt handler.
+     */
+    void pump() {
+        for (int n = SerialUSB.available(); n > 0 && ring_.space() > 0; n--) {
+            ring_.push(SerialUSB.read());
+            bytes_rx_++;
+        }
+    }
+
+    /**
+     * Receives and parses whatever has arrived, without blocking. Complete columns
+     * are queued in the two slots; parsing pauses while both hold unprocessed
+     * columns, which in turn holds off the host. A command that makes no progress
+     * for ALLOCATE_TASK_MILLIS is abandoned.
+     */
+    void poll() {
+        if (!port_usb_) return;
+        pump();
+
+        uint8_t b;
+        while (!stalled() && ring_.pop(b)) {
+            parse(b);
+            last_rx_ = millis();
+        }
+
+        if (state_ == STATE_COMMAND || stalled()) {
+            last_rx_ = millis();
+        } else if (millis() - last_rx_ > ALLOCATE_TASK_MILLIS) {
+            timeouts_++;
+            abort();
+        }
+    }
+
+    // Whether a received column is waiting to be processed
+    bool columnReady() const { return slots_ready_ > 0 || replay_; }
+
+    /**
+     * Hands the oldest received column to sink one sample at a time, in the
+     * transmitted units: floats multiplied by 100. Polls the port first, and again
+     * once the slot is free. Returns the number of samples delivered, 0 if no column
+     * is complete yet.
+     */
+    template <typename Sink>
+    uint16_t receive(Sink&& sink) {
+        uint16_t n = 0;
+
+        // Benchmark runs replay the uploaded A-scan in place of the port
+        if (replay_) {
+            for (; n < bench_scan_.size(); n++)
+                sink(bench_scan_[n]);
+            return n;
+        }
+
+        poll();
+        if (slots_ready_ == 0) return n;
+
+        const Scan& scan = slots_[slot_read_];
+        for (; n < scan.size(); n++)
+            sink(scan[n]);
+        slot_read_ ^= 1;
+        slots_ready_--;
+
+        poll(); // the next column may now be parsed into the freed slot
+        return n;
+    }
+
+    /**
+     * Tracks the connection state of both ports. Meant to be called once in a while,
+     * not on every tick.
+     */
+    void checkConnections(const bool update_display = false) {
         // Programming USB port (S1)
         if (port_prg_) {
             // connected ...
@@ -194,6 +522,33 @@ class SerialStream {
         display_->setTextColor(display_->colorScale()); // reset colour
     }
 
-    bool s1() { return port_prg_; }
-    bool s2() { return port_usb_; }
+    bool scheduledBench() const { return bench_pending_; }
+    const BenchRequest& benchRequest() const { return bench_; }
+    void replay(const bool enable) { replay_ = enable; }
+
+    /**
+     * Sends the result of the scheduled benchmark and returns to standby. Format:
+     * CMD_ACK, runs (2), profiled (1), total (4), number of stages (1), then the mean
+     * (4) and max (4) of each stage, all in ns.
+     */
+    void finishBench(const BenchResult& res) {
+        reply(CMD_ACK);
+        write(res.runs, 2);
+        write(res.profiled, 1);
+        write(res.total_ns, 4);
+        write(BENCH_STAGES, 1);
+        for (uint8_t i = 0; i < BENCH_STAGES; i++) {
+            write(res.mean_ns[i], 4);
+            write(res.max_ns[i], 4);
+        }
+        bench_pending_ = false;
+        status_ = STATUS_STANDBY;
+    }
+
+    bool s1() const { return port_prg_; }
+    bool s2() const { return port_usb_; }
+
+    uint32_t bytesReceived() const { return bytes_rx_; }
+    uint16_t nacks() const         { return nacks_; }
+    uint16_t timeouts() const      { return timeouts_; }
 };
\ No newline at end of file
@@ -3,93 +3,292 @@
 #include <Arduino.h>
 #include <Streaming.h>
 #include "util/Array.h"
-#include "util/timer.hpp"
+#include "util/fixed.hpp"
+#include "util/cx_math.hpp"
+#include "util/profiler.hpp"
+#include "util/arena.hpp"
 #include "display/screen.hpp"
 #include "serial_server.hpp"
+#include "dsp/envelope_stream.hpp"
+#include "dsp/polyphase_decimator.hpp"
+#include "dsp/carrier_envelope.hpp"
+#include "dsp/tone_map.hpp"
+#include "dsp/depth_gate.hpp"
+
+// A-scan processing pipelines, selected at compile time via PIPELINE
+#define PIPELINE_FLOAT 0 // floating point reference chain
+#define PIPELINE_FIXED 1 // fixed-point (Q15/Q31) chain for the FPU-less Cortex-M3
+#define PIPELINE_FUSED 2 // single-pass streaming envelope stage, no intermediate buffers
+#define PIPELINE_POLYPHASE 3 // rectification and anti-aliased polyphase resampling
+
+#ifndef PIPELINE
+#define PIPELINE PIPELINE_FLOAT
+#endif
+
+// Dispatch the polyphase pipeline to variants specialised for common configurations
+#ifndef PRESETS
+#define PRESETS true
+#endif
+
+// Envelope detection ahead of the polyphase resampler, selected at compile time via ENVELOPE
+#define ENVELOPE_RECTIFY 0 // half-wave rectification, low-passed by the resampler
+#define ENVELOPE_QUADRATURE 1 // I/Q mixing at cfg::freq() with a one-period moving average
+#define ENVELOPE_HILBERT 2 // analytic signal magnitude via a short FIR Hilbert transformer
+
+#ifndef ENVELOPE
+#define ENVELOPE ENVELOPE_RECTIFY
+#endif
+
+// Synthetic A-scans while no host streams: number of echoes (first n of gen::ECHO_POS),
+// depth [us] the echo positions are spread over and jitter seed
+#ifndef GEN_ECHOES
+#define GEN_ECHOES gen::MAX_ECHOES
+#endif
+
+#ifndef GEN_DEPTH
+#define GEN_DEPTH gen::TLIM
+#endif
+
+#ifndef GEN_SEED
+#define GEN_SEED gen::SEED
+#endif
 
 namespace gen {
     static const float ECHO_POS[] = {0, 1.3, 3.2, 3.8, 5, 6, 7}; // microseconds
-    static const Array<float, 7> ECHOES(ECHO_POS);
     static const uint16_t RES = 200; // number of points to generate for waveform initially
     static const uint16_t TLIM = 8;
+    static const uint8_t  MAX_ECHOES = sizeof(ECHO_POS) / sizeof(ECHO_POS[0]);
+    static const uint8_t  AMPLITUDES = 4; // echo amplitudes 0.2, 0.3, 0.4 and 0.5
+    static const uint8_t  SHAPE_SHIFT = 6; // fractional bits of the echo templates
+    static const uint32_t SEED = 0x2545F491; // default jitter seed
+
+    // |sin(40 t)| carrier over the generated time span, Q15
+    struct Carrier {
+        fx::q15_t v[RES];
+
+        constexpr Carrier() : v() {
+            for (uint16_t i = 0; i < RES; i++)
+                v[i] = cx::lround(cx::fabs(cx::sin(40. * TLIM * i / (RES-1))) * fx::Q15_MAX);
+        }
+    };
+
+    // A sinc((t-0.5)/0.115) e^(3(A-t)) decay per amplitude, 1/100 units with SHAPE_SHIFT fractional bits
+    struct Templates {
+        uint16_t v[AMPLITUDES][RES];
+
+        constexpr Templates() : v() {
+            for (uint8_t a = 0; a < AMPLITUDES; a++) {
+                const double A = (a+2) / 10.;
+                for (uint16_t d = 0; d < RES; d++) {
+                    const double x = (double) TLIM * d / (RES-1) - 0.5;
+                    const double decay = x == 0 ? A/0.115 : A * cx::sin(x/0.115) / x;
+                    v[a][d] = cx::lround(cx::fabs(decay * cx::exp(3*(A - x - 0.5))) * 100 * (1 << SHAPE_SHIFT));
+                }
+            }
+        }
+    };
+
+    // 1/(order+3) echo weights, Q15
+    struct Weights {
+        fx::q15_t v[MAX_ECHOES];
+
+        constexpr Weights() : v() {
+            for (uint8_t i = 0; i < MAX_ECHOES; i++)
+                v[i] = cx::lround((double) fx::Q15_MAX / (i+3));
+        }
+    };
+
+    static constexpr Carrier   CARRIER{};
+    static constexpr Templates TEMPLATES{};
+    static constexpr Weights   WEIGHTS{};
+}
+
+/**
+ * Upper bounds of the scratch memory one A-scan takes through each pipeline, for the
+ * largest window cfg allows. Every pipeline can be selected at runtime, so the arena
+ * is sized for the largest of them and reserves nothing beyond.
+ */
+namespace scratch {
+    static const uint16_t WINDOW = cfg::def::MAX_T-cfg::def::MIN_T;
+    static constexpr size_t GEN_BYTES = footprint<Array<int16_t, gen::RES>>();
+    static constexpr size_t DEMODULATE_BYTES = footprint<
+            Array<uint16_t, WINDOW>, Array<uint16_t, WINDOW>, Array<fx::q16_t, IMG_HEIGHT>,
+            Array<fx::q16_t, IMG_HEIGHT>, Array<fx::q16_t, IMG_HEIGHT>>();
+    static constexpr size_t FLOAT_BYTES = GEN_BYTES + footprint<
+            Array<float, WINDOW>, Array<uint16_t, WINDOW>, Array<float, WINDOW>,
+            Array<float, WINDOW>, Array<float, WINDOW>, Array<float, IMG_HEIGHT>,
+            Array<float, IMG_HEIGHT>, Array<float, IMG_HEIGHT>, Array<float, IMG_HEIGHT>,
+            Array<fx::q16_t, IMG_HEIGHT>>();
+    static constexpr size_t FIXED_BYTES = GEN_BYTES + DEMODULATE_BYTES +
+            footprint<Array<uint16_t, WINDOW>, Array<fx::q16_t, IMG_HEIGHT>>();
+    static constexpr size_t POLYPHASE_BYTES = FIXED_BYTES +
+            footprint<Array<int16_t, WINDOW>>(); // RF ahead of carrier detection
+    static constexpr size_t FUSED_BYTES = GEN_BYTES;
+    static constexpr size_t PEAK_BYTES = FLOAT_BYTES > POLYPHASE_BYTES ? FLOAT_BYTES : POLYPHASE_BYTES;
+
+    inline Arena<PEAK_BYTES> arena; // shared by all pipelines; one A-scan is processed at a time
+
+    template <typename T>
+    T& make() { return arena.make<T>(); }
 }
 
 template <size_t N>
-Array<float, N> linspace(const float min,
-                         const float max,
-                         const uint16_t n) {
-    Array<float, N> result;
+void linspace(const float min,
+              const float max,
+              const uint16_t n,
+              Array<float, N>& result) {
+    result.clear();
 
     const float step = (max-min) / (floor((float) n) - 1.); // step size
     for (uint16_t i = 0; i < n-1; i++)
         result.push_back(min + i*step); // fill vector
 
     result.push_back(max); // fix last entry to max
-    return result;
 }
 
-// TODO: Optimise class
+/**
+ * Synthetic pulse-echo waveforms from tables built at compile time. Each sample of an
+ * echo is its decaying template at the offset from the echo start, modulated by the
+ * rectified carrier and weighted by the echo order; only the amplitude is drawn per
+ * sample, from a seeded xorshift generator, so frames are reproducible across runs.
+ */
 class SignalGenerator {
 
    public:
-    
-    static Array<float, gen::RES> generateEcho(const Array<float, gen::RES> tspan,
-                                               const uint16_t t) {
-        const uint16_t tstart = int(t*gen::RES/gen::TLIM);
-        const uint8_t k = 0.2;  // min signal
-        Array<float, gen::RES> echo;
-
-        for (uint16_t i = 0; i < gen::RES; i++) {
-            if (i < tstart) {
-                echo.push_back(0); // delay waveform start
-                continue;
-            }
-
-            const float A = random(2, 6) / 10.; // amplitude (random)
-            float cyc = sin(40*tspan[i]); // sinusoidal component
-            float cyc_decay = A * sin((tspan[i]-t-0.5)/0.115)/(tspan[i]-t-0.5) + k; // sinusoidal decay component
-            float exp_decay = exp(3*(A-tspan[i]) + 3*t) + k; // exponential decay component
 
-            echo.push_back(abs(cyc * cyc_decay * exp_decay)); // compile waveform
+    /**
+     * Sets the number of echoes (first n of gen::ECHO_POS) and the depth [us] the echo
+     * positions are spread over. SignalProcessor::configure() applies GEN_ECHOES and
+     * GEN_DEPTH; nothing is generated before.
+     */
+    static void configure(const uint8_t n_echoes,
+                          const uint16_t depth) {
+        n_echoes_ = n_echoes > gen::MAX_ECHOES ? gen::MAX_ECHOES : n_echoes;
+        for (uint8_t k = 0; k < n_echoes_; k++) {
+            // echo positions are whole microseconds
+            const uint16_t t = gen::ECHO_POS[k];
+            start_[k] = (uint32_t) t * depth * gen::RES / ((uint32_t) gen::TLIM * gen::TLIM);
         }
+    }
 
-        return echo;
+    // Restarts the jitter sequence; unlike configure(), frames repeat from here
+    static void reseed(const uint32_t seed) {
+        seed_ = seed == 0 ? gen::SEED : seed;
     }
 
-    static Array<float, gen::RES> generateEchoes() {
-        float echoes[gen::RES] = {};
-        Array<float, gen::RES> tspan = linspace<gen::RES>(0, gen::TLIM, gen::RES);
+    /**
+     * Generates samples [first, first+count) of gen::RES (bounded by N) of a noisy
+     * pulse-echo waveform in transmitted units (1/100). Samples outside the range
+     * are not computed.
+     */
+    template <size_t N>
+    static void generateEchoes(Array<int16_t, N>& echoes,
+                               const uint16_t first = 0,
+                               const uint16_t count = gen::RES) {
+        const uint16_t lo = first < gen::RES ? first : gen::RES;
+        const uint16_t avail = gen::RES - lo;
+        const uint16_t n = count < avail ? count : avail;
+        const uint16_t end = lo + (n < N ? n : N);
+        int32_t acc[gen::RES];
+        for (uint16_t i = lo; i < end; i++) acc[i] = 0;
+
+        // compile pseudo-randomly jittered pulse-echo waveforms
+        for (uint8_t k = 0; k < n_echoes_; k++) {
+            const fx::q15_t w = gen::WEIGHTS.v[k];
+            for (uint16_t i = start_[k] > lo ? start_[k] : lo; i < end; i++) {
+                const uint32_t pulse = ((uint32_t) gen::TEMPLATES.v[next() & 3][i - start_[k]] * gen::CARRIER.v[i]) >> fx::Q15_SHIFT;
+                acc[i] += (pulse * w) >> fx::Q15_SHIFT;
+            }
+        }
 
-        // compile randomly generated noisy pulse-echo waveforms
-        for (uint8_t t = 0; t < gen::ECHOES.size(); t++) {
-            Array<float, gen::RES> echo = SignalGenerator::generateEcho(tspan, gen::ECHOES[t]);
-            for (uint16_t i = 0; i < gen::RES; i++)
-                echoes[i] += echo[i]/(t+3);
+        echoes.clear();
+        for (uint16_t i = lo; i < end; i++) {
+            const int32_t e = (acc[i] + (1 << (gen::SHAPE_SHIFT-1))) >> gen::SHAPE_SHIFT;
+            echoes.push_back(e > INT16_MAX ? INT16_MAX : e);
         }
+    }
+
+    /**
+     * Float variant of generateEchoes() for the reference chain.
+     */
+    template <size_t N>
+    static void generateEchoes(Array<float, N>& echoes,
+                               const uint16_t first = 0,
+                               const uint16_t count = gen::RES) {
+        SCRATCH_FRAME();
+        auto& raw = scratch::make<Array<int16_t, gen::RES>>();
+        generateEchoes(raw, first, count);
+        echoes.clear();
+        for (uint16_t i = 0; i < raw.size(); i++)
+            echoes.push_back(raw[i] / 100.);
+    }
 
-        return Array<float, gen::RES>(echoes);
+   private:
+    static uint32_t next() { // xorshift32
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
     }
+
+    static inline uint32_t seed_ = GEN_SEED;
+    static inline uint8_t  n_echoes_ = 0; // set by configure()
+    static inline uint16_t start_[gen::MAX_ECHOES] = {};
 };
 
 // TODO: Optimise class
 class SignalProcessor {
 
    public:
-    static inline float env_max_ = 0;
+    static inline ToneMap<IMG_HEIGHT> tone_; // brightness mapping shared by all pipelines
+
+    using Pipeline = void (*)(const ColumnSpan, SerialStream*);
+    static inline Pipeline stream_preset_ = NULL; // specialised variants for the current cfg
+    static inline Pipeline gen_preset_    = NULL;
+    static inline depth::Gate stream_gate_; // samples within cfg's depth window, per source
+    static inline depth::Gate gen_gate_;
+
+    /**
+     * Rebuilds configuration dependent tables; call on start-up and whenever
+     * cfg::update() has been scheduled.
+     */
+    static void configure(const uint16_t n_rows = IMG_HEIGHT) {
+        tone_.configure(n_rows);
+        SignalGenerator::configure(GEN_ECHOES, GEN_DEPTH);
+
+        // The stream is sampled at cfg::sampRate() from cfg::minT(); the generator
+        // spreads gen::RES samples over gen::TLIM microseconds
+        stream_gate_ = depth::gate(cfg::numPtsLocal(), cfg::minT(),
+                                   (uint32_t) cfg::sampRate() << fx::Q16_SHIFT,
+                                   cfg::speedSound(), cfg::depthMin(), cfg::depthMax());
+        gen_gate_    = depth::gate(gen::RES, 0,
+                                   ((uint32_t) (gen::RES-1) << fx::Q16_SHIFT) / gen::TLIM,
+                                   cfg::speedSound(), cfg::depthMin(), cfg::depthMax());
+#if PRESETS
+        stream_preset_ = findPreset(stream_gate_.count, n_rows, cfg::imgScale());
+        gen_preset_    = findPreset(gen_gate_.count, n_rows, cfg::imgScale());
+#endif
+    }
 
-    template <size_t N>
-    static Array<uint16_t, N> findPeaks(const Array<float, N> signal) {
+    // Depth gate of the streamed A-scans, or of the generator
+    static const depth::Gate& gate(const bool stream) { return stream ? stream_gate_ : gen_gate_; }
+
+    template <typename T, size_t N>
+    static void findPeaks(const ArrayView<T> signal,
+                          Array<uint16_t, N>& peak_idxs) {
         const uint16_t len = signal.size();
-        Array<uint16_t, N> peak_idxs;
+        peak_idxs.clear();
 
-        float m_ = 0; // previous derivative
+        using D = decltype(T() - T()); // signed derivative type
+        D m_ = 0; // previous derivative
         for (uint16_t x = 0; x < len; x++) {
-            const float y = signal[x];
+            const T y = signal[x];
             const uint16_t x_ = max(x-1, 0); // previous x, bounded by 0
-            const float y_ = signal[x_]; // previous y
+            const T y_ = signal[x_]; // previous y
 
-            // Detect local maxima by looking at the change in local derivative
-            const float m = x == 0 ? 0 : (y-y_) / float(x-x_); // derivative
+            // Detect local maxima by looking at the change in local derivative.
+            // Samples are unit spaced, so the difference is the derivative.
+            const D m = x == 0 ? 0 : y-y_; // derivative
             if (m_ >= 0 && m < 0) {
                 // Change occurred post-peak; record previous point as a local max
                 peak_idxs.push_back(x_);
@@ -99,31 +298,31 @@ class SignalProcessor {
         }
 
         peak_idxs.push_back(len-1); // append final index to finish waveform
-        return peak_idxs;
     }
 
     // TODO: Make downsampling uniform
     template <size_t N>
-    static Array<float, N> downsample(const Array<float, N> array,
-                                      const uint16_t npts) {
+    static void downsample(const ArrayView<float> array,
+                           const uint16_t npts,
+                           Array<float, N>& array_ds) {
         const uint16_t oldsize = array.size();
-        Array<float, N> array_ds;
+        array_ds.clear();
         for (uint16_t i = 0; i < npts-1; i++) {
             const uint16_t idx = i * (oldsize-1)/(npts-1);
             const uint16_t p = i * (oldsize-1)%(npts-1);
             array_ds.push_back(((p * array[idx+1]) + ((npts-1 - p) * array[idx])) / (npts-1));
         }
         array_ds.push_back(array[oldsize-1]); // done outside of loop to avoid out of bound access
-        return array_ds;
     }
 
     template <size_t N>
-    static Array<float, N> interpLin(const Array<float, N> x,
-                                     const Array<float, N> y,
-                                     const Array<float, N> x_new,
-                                     const bool extrap_bounds=true) {
+    static void interpLin(const ArrayView<float> x,
+                          const ArrayView<float> y,
+                          const ArrayView<float> x_new,
+                          Array<float, N>& y_new, // interpolated y series
+                          const bool extrap_bounds=true) {
         const uint16_t n_val = x_new.size(); // resampling number
-        Array<float, N> y_new; // interpolated y series
+        y_new.clear();
         for (uint16_t idx = 0; idx < n_val; idx++) {
             const float x_pt = x_new[idx];
 
@@ -156,110 +355,504 @@ class SignalProcessor {
 
             y_new.push_back(rst);
         }
-        return y_new;
     }
 
-    // TODO: Optimise
-    static Column receiveAScan(const uint16_t n_rows = IMG_HEIGHT,
-                               SerialStream* usb = NULL) {
-        // Record time
-        Timer timer;
-        timer.start();
+    // Fixed-point counterpart of downsample(): integer input, Q16.16 output
+    template <typename T, size_t N>
+    static void downsampleFixed(const ArrayView<T> array,
+                                const uint16_t npts,
+                                Array<fx::q16_t, N>& array_ds) {
+        const uint16_t oldsize = array.size();
+        array_ds.clear();
+        for (uint16_t i = 0; i < npts-1; i++) {
+            const uint16_t idx = i * (oldsize-1)/(npts-1);
+            const uint16_t p = i * (oldsize-1)%(npts-1);
+            array_ds.push_back(fx::divQ16((uint32_t) p * array[idx+1] +
+                                          (uint32_t) (npts-1 - p) * array[idx], npts-1));
+        }
+        array_ds.push_back(fx::toQ16(array[oldsize-1])); // done outside of loop to avoid out of bound access
+    }
+
+    // Fixed-point counterpart of linspace() over Q16.16 positions
+    template <size_t N>
+    static void linspaceFixed(const fx::q16_t min,
+                              const fx::q16_t max,
+                              const uint16_t n,
+                              Array<fx::q16_t, N>& result) {
+        result.clear();
+
+        const int32_t step = ((int32_t) max - (int32_t) min) / (n-1); // step size
+        for (uint16_t i = 0; i < n-1; i++)
+            result.push_back(min + i*step); // fill vector
+
+        result.push_back(max); // fix last entry to max
+    }
+
+    // Fixed-point counterpart of interpLin() with bound extrapolation
+    template <size_t N>
+    static void interpLinFixed(const ArrayView<fx::q16_t> x,
+                               const ArrayView<fx::q16_t> y,
+                               const ArrayView<fx::q16_t> x_new,
+                               Array<fx::q16_t, N>& y_new) { // interpolated y series
+        const uint16_t n_val = x_new.size(); // resampling number
+        y_new.clear();
+        uint16_t i = 0; // x_new is ascending, so the segment search never restarts
+        for (uint16_t idx = 0; idx < n_val; idx++) {
+            const fx::q16_t x_pt = x_new[idx];
 
+            // extrapolate when out of bounds
+            if (x_pt <= x[0]) {
+                y_new.push_back(y[0]);
+                continue;
+            }
+            if (x_pt >= x[n_val-1]) {
+                y_new.push_back(y[n_val-1]);
+                continue;
+            }
+
+            while (x_pt >= x[i+1]) i++;
+            const fx::q15_t t = fx::ratioQ15(x_pt - x[i], x[i+1] - x[i]);
+            y_new.push_back(fx::lerpQ16(y[i], y[i+1], t));
+        }
+    }
+
+    static void receiveAScan(const ColumnSpan col,
+                             const uint16_t n_rows = IMG_HEIGHT,
+                             SerialStream* usb = NULL) {
+        PROFILE(ZONE_ASCAN);
+#if PIPELINE == PIPELINE_FIXED
+        receiveAScanFixed(col, n_rows, usb);
+#elif PIPELINE == PIPELINE_FUSED
+        receiveAScanFused(col, n_rows, usb);
+#elif PIPELINE == PIPELINE_POLYPHASE
+        receiveAScanPolyphase(col, n_rows, usb);
+#else
+        receiveAScanFloat(col, n_rows, usb);
+#endif
+    }
+
+    /**
+     * Runs the pipeline with the given PIPELINE_* id rather than the compiled one, as
+     * for on-device benchmarks. Unknown ids fall back to the compiled pipeline.
+     */
+    static void receiveAScanWith(const uint8_t pipeline,
+                                 const ColumnSpan col,
+                                 const uint16_t n_rows = IMG_HEIGHT,
+                                 SerialStream* usb = NULL) {
+        PROFILE(ZONE_ASCAN);
+        switch (pipeline <= PIPELINE_POLYPHASE ? pipeline : PIPELINE) {
+            case PIPELINE_FIXED:     receiveAScanFixed(col, n_rows, usb); break;
+            case PIPELINE_FUSED:     receiveAScanFused(col, n_rows, usb); break;
+            case PIPELINE_POLYPHASE: receiveAScanPolyphase(col, n_rows, usb); break;
+            default:                 receiveAScanFloat(col, n_rows, usb); break;
+        }
+    }
+
+    // TODO: Optimise
+    static void receiveAScanFloat(const ColumnSpan col,
+                                  const uint16_t n_rows = IMG_HEIGHT,
+                                  SerialStream* usb = NULL) {
         const uint16_t RES = cfg::def::MAX_T-cfg::def::MIN_T; // initial axial resolution
         uint16_t init_res = 0;
         float tlim = 1.;
         float min = 0;
         float max = 1;
-        Array<float, RES> signal;
-
-        if (usb != NULL && usb->s2()) {
-            // If native USB connected, extract echo from stream
-            Array<float, RES> echo = usb->listen<RES>();
-            for (uint16_t i = 0; i < echo.size(); i++)
-                signal.push_back(echo[i]);
-            tlim = cfg::acqTime();
-            init_res = cfg::numPtsLocal();
-            min = tlim;
-            max = tlim/(init_res/200);
-        } else {
-            // Otherwise generate randomly
-            Array<float, gen::RES> gen = SignalGenerator::generateEchoes();
-            for (uint16_t i = 0; i < min(RES, gen::RES); i++)
-                signal.push_back(gen[i]);
-            // we are rendering full window of the generated waveform
-            tlim = gen::TLIM;
-            init_res = gen::RES;
-        }
+        SCRATCH_FRAME();
+        auto& signal = scratch::make<Array<float, RES>>();
+
+        {
+            PROFILE(ZONE_ACQUIRE);
+            if (usb != NULL && usb->s2()) {
+                // If native USB connected, extract the gated echo from stream
+                receiveGated(usb, [&signal](const int16_t sample) { signal.push_back((float) sample / 100.); });
+                if (signal.empty()) signal.assign(stream_gate_.count, 0);
+                tlim = cfg::acqTime();
+                init_res = stream_gate_.count;
+                min = tlim;
+                max = tlim/(init_res < 200 ? 1 : init_res/200);
+            } else {
+                // Otherwise generate randomly
+                SignalGenerator::generateEchoes(signal, gen_gate_.first, gen_gate_.count);
+                // we are rendering full window of the gated waveform
+                tlim = gen::TLIM;
+                init_res = signal.size();
+            }
 
-        for (uint16_t i = 0; i < signal.size(); i++) {
-            // Disregard all negatives from processing
-            if (signal[i] < 0) signal[i] = 0;
+            for (uint16_t i = 0; i < signal.size(); i++) {
+                // Disregard all negatives from processing
+                if (signal[i] < 0) signal[i] = 0;
 
-            // Create some vertical limitations
-            if (signal[i] > 0xFF-cfg::gain()) signal[i] = 0xFF-cfg::gain();
+                // Create some vertical limitations
+                if (signal[i] > 0xFF-cfg::gain()) signal[i] = 0xFF-cfg::gain();
+            }
         }
         
         // Create envelope; demodulate
-        const Array<uint16_t, RES> peaks_idx = findPeaks(signal); // extract indices at peaks
-        const uint16_t n_peaks = peaks_idx.size(); // number of peaks detected
-
-        Array<float, RES> tspan = linspace<RES>(0, tlim, init_res);
-        Array<float, RES> peaks; // x axis: time
-        Array<float, RES> envelope; // y axis: signal intensity
-        for (uint16_t i = 0; i < n_peaks; i++) {
-            peaks.push_back(tspan[peaks_idx[i]]); // convert peak index to time unit
-            envelope.push_back(signal[peaks_idx[i]]); // obtain signal intensity at peak time
+        auto& peaks_idx = scratch::make<Array<uint16_t, RES>>();
+        auto& tspan = scratch::make<Array<float, RES>>();
+        auto& peaks = scratch::make<Array<float, RES>>(); // x axis: time
+        auto& envelope = scratch::make<Array<float, RES>>(); // y axis: signal intensity
+        {
+            PROFILE(ZONE_ENVELOPE);
+            findPeaks(signal.view(), peaks_idx); // extract indices at peaks
+            const uint16_t n_peaks = peaks_idx.size(); // number of peaks detected
+
+            linspace(0, tlim, init_res, tspan);
+            for (uint16_t i = 0; i < n_peaks; i++) {
+                peaks.push_back(tspan[peaks_idx[i]]); // convert peak index to time unit
+                envelope.push_back(signal[peaks_idx[i]]); // obtain signal intensity at peak time
+            }
         }
 
-        // Downsample into display size. Currently performed
-        // on natural instead of smooth to preserve accuracy.
-        Array<float, IMG_HEIGHT> peaks_ds = downsample(peaks, n_rows);
-        Array<float, IMG_HEIGHT> env_ds = downsample(envelope, n_rows);
-
-        // Interpolate across series to uniformly spread out the values
-        // TODO: May want to make downsampling uniform in the first place
-        Array<float, IMG_HEIGHT> env = interpLin(peaks_ds, env_ds, 
-                linspace<IMG_HEIGHT>(min, max*tspan[init_res-1], n_rows));
+        auto& x_new = scratch::make<Array<float, IMG_HEIGHT>>();
+        auto& env = scratch::make<Array<float, IMG_HEIGHT>>();
+        {
+            PROFILE(ZONE_RESAMPLE);
+
+            // Downsample into display size. Currently performed
+            // on natural instead of smooth to preserve accuracy.
+            auto& peaks_ds = scratch::make<Array<float, IMG_HEIGHT>>();
+            auto& env_ds = scratch::make<Array<float, IMG_HEIGHT>>();
+            downsample(peaks.view(), n_rows, peaks_ds);
+            downsample(envelope.view(), n_rows, env_ds);
+
+            // Interpolate across series to uniformly spread out the values
+            // TODO: May want to make downsampling uniform in the first place
+            linspace(min, max*tspan[init_res-1], n_rows, x_new);
+            interpLin(peaks_ds.view(), env_ds.view(), x_new.view(), env);
+        }
         
         /*
         usb->display_->fillRect(0, 0, 60, 10, usb->display_->colorBlack());
         usb->display_->print(0, 0, sspan.size());
         usb->display_->printFloat(30, 0, sspan[130]);*/
 
-        // Find max val and store across entire BScan
-        for (uint16_t i = 1; i < n_rows; i++)
-            if (env[i] > env_max_)
-                env_max_ = env[i];
-
         // Convert to RGB565 shade of grey (8-bit) for better storage and faster processing
-        Column col = col::BLACK; // greyscale format
+        auto& env_fixed = scratch::make<Array<fx::q16_t, IMG_HEIGHT>>();
         for (uint16_t i = 0; i < n_rows; i++)
-            col[i] = round(env[i]*255/env_max_); // normalise between 0 and 255
-                
-        uint32_t ms = timer.stop();
+            env_fixed.push_back(env[i] * fx::Q16_ONE);
+        tone_.map(env_fixed.view(), col);
+    }
 
-        return col;
+    /**
+     * Integer-only variant of receiveAScanFloat(). Samples are kept in the transmitted
+     * units (1/100), time is tracked as Q16.16 sample positions and interpolation uses
+     * Q15 fractions, so no soft-float routine is called per sample or per pixel.
+     */
+    static void receiveAScanFixed(const ColumnSpan col,
+                                  const uint16_t n_rows = IMG_HEIGHT,
+                                  SerialStream* usb = NULL) {
+        const uint16_t RES = cfg::def::MAX_T-cfg::def::MIN_T; // initial axial resolution
+        fx::q16_t min = 0; // displayed window in sample positions
+        fx::q16_t max = 0;
+        SCRATCH_FRAME();
+        auto& signal = scratch::make<Array<uint16_t, RES>>();
+        acquireFixed(signal, min, max, usb);
+
+        auto& env = scratch::make<Array<fx::q16_t, IMG_HEIGHT>>();
+        demodulateFixed(signal.view(), min, max, n_rows, env);
+        tone_.map(env.view(), col);
     }
 
-    // TODO: Optimise
-    static Image receiveBScan(const uint16_t n_rows = IMG_HEIGHT,
-                              const uint16_t n_cols = IMG_WIDTH,
-                              SerialStream* usb = NULL) {
-        // stored and processed transposed for easy column extraction
-        Image image; // greyscale format
-
-        // Record time
-        Timer timer;
-        timer.start();
-        for (uint16_t col = 0; col < n_cols; col++) {
-            Column column = receiveAScan(n_rows, usb);
-
-            // Append single column of a B-mode image
-            image.push_back(column);
+    /**
+     * Polyphase variant of receiveAScanFixed(). The clamped (half-wave rectified)
+     * signal is low-passed and resampled onto the rows in one pass, which yields the
+     * envelope without peak picking. With ENVELOPE set to a carrier-aware detector,
+     * streamed RF is demodulated at the probe frequency first. Configurations without
+     * a compile-time resampler fall back to the peak envelope of receiveAScanFixed().
+     */
+    static void receiveAScanPolyphase(const ColumnSpan col,
+                                      const uint16_t n_rows = IMG_HEIGHT,
+                                      SerialStream* usb = NULL) {
+#if PRESETS
+        const Pipeline preset = usb != NULL && usb->s2() ? stream_preset_ : gen_preset_;
+        if (preset != NULL) {
+            preset(col, usb);
+            return;
         }
-        uint32_t ms = timer.stop();
+#endif
+        const uint16_t RES = cfg::def::MAX_T-cfg::def::MIN_T; // initial axial resolution
+        fx::q16_t min = 0; // displayed window in sample positions
+        fx::q16_t max = 0;
+        SCRATCH_FRAME();
+        auto& signal = scratch::make<Array<uint16_t, RES>>();
+        acquireEnvelope(signal, min, max, usb);
+
+        auto& env = scratch::make<Array<fx::q16_t, IMG_HEIGHT>>();
+        if (!decimate(signal.view(), n_rows, env))
+            demodulateFixed(signal.view(), min, max, n_rows, env);
+        tone_.map(env.view(), col);
+    }
 
-        return image; // return greyscale format
+    /**
+     * receiveAScanPolyphase() specialised for A-scans of N_IN samples onto ROWS rows
+     * at image scale SCALE. Buffers are sized to the input instead of the largest
+     * window, and the resampler runs from its compile-time row tables without size
+     * checks. configure() selects the variant matching the configuration.
+     */
+    template <uint16_t N_IN, uint16_t ROWS, uint8_t SCALE>
+    static void receiveAScanPreset(const ColumnSpan col,
+                                   SerialStream* usb = NULL) {
+        static_assert(ROWS == IMG_HEIGHT/SCALE, "preset rows must match the image scale");
+        static_assert(N_IN >= gen::RES && N_IN <= scratch::WINDOW, "preset window out of range");
+        fx::q16_t min = 0; // unused: the resampler spans the whole A-scan
+        fx::q16_t max = 0;
+        SCRATCH_FRAME();
+        auto& signal = scratch::make<Array<uint16_t, N_IN>>();
+        acquireEnvelope(signal, min, max, usb);
+
+        auto& env = scratch::make<Array<fx::q16_t, ROWS>>();
+        {
+            PROFILE(ZONE_RESAMPLE);
+            PolyphaseDecimator<N_IN, ROWS>::process(signal.view(), env);
+        }
+        tone_.map(env.view(), col);
+    }
+
+    /**
+     * Acquires a non-negative envelope ahead of the polyphase resampler: the clamped
+     * (half-wave rectified) signal, or with a carrier-aware ENVELOPE detector the
+     * demodulated RF of a streamed A-scan.
+     */
+    template <size_t N>
+    static void acquireEnvelope(Array<uint16_t, N>& signal,
+                                fx::q16_t& min,
+                                fx::q16_t& max,
+                                SerialStream* usb = NULL) {
+#if ENVELOPE == ENVELOPE_RECTIFY
+        acquireFixed(signal, min, max, usb);
+#else
+        SCRATCH_FRAME();
+        auto& rf = scratch::make<Array<int16_t, N>>();
+        acquireFixed(rf, min, max, usb);
+
+        // The generator already emits a rectified magnitude; only streamed RF is demodulated
+        signal.clear();
+        if (usb != NULL && usb->s2()) {
+            demodulateCarrier(rf.view(), signal);
+        } else {
+            for (uint16_t i = 0; i < rf.size(); i++)
+                signal.push_back(rf[i]);
+        }
+#endif
+    }
+
+    /**
+     * Acquires an A-scan clamped to [0, 0xFF-gain] in transmitted units (1/100),
+     * along with its displayed window in Q16.16 sample positions. Signed buffers keep
+     * the negative half-wave, clamped symmetrically, for carrier-aware detectors.
+     */
+    template <typename T, size_t N>
+    static void acquireFixed(Array<T, N>& signal,
+                             fx::q16_t& min,
+                             fx::q16_t& max,
+                             SerialStream* usb = NULL) {
+        PROFILE(ZONE_ACQUIRE);
+
+        // Disregard negatives unless kept for the carrier; create some vertical limitations
+        const int16_t lim = (0xFF-cfg::gain()) * 100;
+        const int16_t lo = (T) -1 < 0 ? -lim : 0;
+        signal.clear();
+
+        if (usb != NULL && usb->s2()) {
+            // If native USB connected, extract the gated echo from stream as received
+            receiveGated(usb, [&signal, lo, lim](const int16_t sample) {
+                signal.push_back(constrain(sample, lo, lim));
+            });
+            if (signal.empty()) signal.assign(stream_gate_.count, 0);
+            streamWindow(stream_gate_.count, min, max);
+        } else {
+            // Otherwise generate randomly
+            SCRATCH_FRAME();
+            auto& gen = scratch::make<Array<int16_t, gen::RES>>();
+            SignalGenerator::generateEchoes(gen, gen_gate_.first, gen_gate_.count);
+            for (uint16_t i = 0; i < gen.size(); i++)
+                signal.push_back(constrain(gen[i], 0, lim));
+            // we are rendering full window of the gated waveform
+            min = 0;
+            max = fx::toQ16(gen.size()-1);
+        }
+    }
+
+    /**
+     * Uniformly sampled envelope of a signed RF A-scan at the configured probe and
+     * sampling frequencies, using the detector selected by ENVELOPE.
+     */
+    template <size_t N>
+    static void demodulateCarrier(const ArrayView<int16_t> rf,
+                                  Array<uint16_t, N>& envelope) {
+        PROFILE(ZONE_ENVELOPE);
+#if ENVELOPE == ENVELOPE_QUADRATURE
+        static QuadratureDemodulator detector;
+#else
+        static HilbertDemodulator detector;
+#endif
+        detector.begin(envelope::phaseIncrement(cfg::freq(), cfg::sampRate()),
+                       (0xFF-cfg::gain()) * 100);
+        envelope::demodulate(detector, rf, envelope);
+    }
+
+    /**
+     * Peak envelope of a clamped signal resampled onto n_rows positions in [min, max].
+     */
+    template <size_t N>
+    static void demodulateFixed(const ArrayView<uint16_t> signal,
+                                const fx::q16_t min,
+                                const fx::q16_t max,
+                                const uint16_t n_rows,
+                                Array<fx::q16_t, N>& env) {
+        const uint16_t RES = cfg::def::MAX_T-cfg::def::MIN_T; // initial axial resolution
+
+        // Create envelope; demodulate
+        SCRATCH_FRAME();
+        auto& peaks_idx = scratch::make<Array<uint16_t, RES>>();
+        auto& envelope = scratch::make<Array<uint16_t, RES>>(); // y axis: signal intensity
+        {
+            PROFILE(ZONE_ENVELOPE);
+            findPeaks(signal, peaks_idx); // extract indices at peaks
+            const uint16_t n_peaks = peaks_idx.size(); // number of peaks detected
+
+            for (uint16_t i = 0; i < n_peaks; i++)
+                envelope.push_back(signal[peaks_idx[i]]); // obtain signal intensity at peak
+        }
+
+        PROFILE(ZONE_RESAMPLE);
+
+        // Downsample into display size; x axis is kept in sample positions
+        auto& peaks_ds = scratch::make<Array<fx::q16_t, N>>();
+        auto& env_ds = scratch::make<Array<fx::q16_t, N>>();
+        downsampleFixed(peaks_idx.view(), n_rows, peaks_ds);
+        downsampleFixed(envelope.view(), n_rows, env_ds);
+
+        // Interpolate across series to uniformly spread out the values
+        auto& x_new = scratch::make<Array<fx::q16_t, N>>();
+        linspaceFixed(min, max, n_rows, x_new);
+        interpLinFixed(peaks_ds.view(), env_ds.view(), x_new.view(), env);
+    }
+
+    // Compile-time resamplers: default stream window and generator onto the default rows
+    using StreamDecimator = PolyphaseDecimator<cfg::def::MAX_T-cfg::def::MIN_T,
+                                               IMG_HEIGHT/cfg::def::IMG_SCALE>;
+    using GenDecimator    = PolyphaseDecimator<gen::RES, IMG_HEIGHT/cfg::def::IMG_SCALE>;
+
+    /**
+     * Resamples the signal with the matching compile-time resampler. Returns false
+     * if the configuration has none.
+     */
+    template <size_t N>
+    static bool decimate(const ArrayView<uint16_t> signal,
+                         const uint16_t n_rows,
+                         Array<fx::q16_t, N>& env) {
+        if (n_rows != IMG_HEIGHT/cfg::def::IMG_SCALE) return false;
+        PROFILE(ZONE_RESAMPLE);
+
+        if (signal.size() == cfg::def::MAX_T-cfg::def::MIN_T)
+            StreamDecimator::process(signal, env);
+        else if (signal.size() == gen::RES)
+            GenDecimator::process(signal, env);
+        else
+            return false;
+
+        return true;
+    }
+
+    /**
+     * Specialised pipeline for A-scans of n_in samples onto n_rows rows at the given
+     * image scale, or NULL to keep to the generic path.
+     */
+    static Pipeline findPreset(const uint16_t n_in,
+                               const uint16_t n_rows,
+                               const uint8_t scale) {
+        struct Preset {
+            uint16_t n_in;
+            uint16_t n_rows;
+            uint8_t  scale;
+            Pipeline run;
+        };
+        static const Preset PRESET_TABLE[] = {
+            {200,  IMG_HEIGHT,   1, receiveAScanPreset<200,  IMG_HEIGHT,   1>}, // production stream, generator
+            {500,  IMG_HEIGHT,   1, receiveAScanPreset<500,  IMG_HEIGHT,   1>},
+            {1000, IMG_HEIGHT,   1, receiveAScanPreset<1000, IMG_HEIGHT,   1>}, // default window
+            {200,  IMG_HEIGHT/2, 2, receiveAScanPreset<200,  IMG_HEIGHT/2, 2>},
+        };
+
+        for (const Preset& p : PRESET_TABLE)
+            if (p.n_in == n_in && p.n_rows == n_rows && p.scale == scale) return p.run;
+        return NULL;
+    }
+
+    /**
+     * Streaming variant of receiveAScanFixed(). Samples go straight from the serial
+     * port (or generator) into an EnvelopeStream, which clamps, picks peaks and
+     * resamples in a single pass; the only buffer left is the output column.
+     */
+    static void receiveAScanFused(const ColumnSpan col,
+                                  const uint16_t n_rows = IMG_HEIGHT,
+                                  SerialStream* usb = NULL) {
+        static EnvelopeStream<IMG_HEIGHT> stage;
+        const uint16_t lim = (0xFF-cfg::gain()) * 100;
+        fx::q16_t min = 0; // displayed window in sample positions
+        fx::q16_t max = 0;
+
+        {
+            // Acquisition, envelope and resampling are one pass, profiled as the envelope
+            PROFILE(ZONE_ENVELOPE);
+            if (usb != NULL && usb->s2()) {
+                // If native USB connected, demodulate the gated echo straight from its receive slot
+                streamWindow(stream_gate_.count, min, max);
+                stage.begin(n_rows, min, max, lim);
+                receiveGated(usb, [](const int16_t sample) { stage.push(sample); });
+            } else {
+                // Otherwise generate randomly
+                SCRATCH_FRAME();
+                auto& gen = scratch::make<Array<int16_t, gen::RES>>();
+                SignalGenerator::generateEchoes(gen, gen_gate_.first, gen_gate_.count);
+                stage.begin(n_rows, min, fx::toQ16(gen.size()-1), lim);
+                for (uint16_t i = 0; i < gen.size(); i++)
+                    stage.push(gen[i]);
+            }
+        }
+
+        tone_.map(stage.finish().view(), col);
+    }
+
+    /**
+     * Hands the samples of the next streamed A-scan that fall within the depth gate
+     * to sink; the others are drained from the receive slot unprocessed.
+     */
+    template <typename Sink>
+    static void receiveGated(SerialStream* usb, Sink&& sink) {
+        const depth::Gate& g = stream_gate_;
+        uint16_t i = 0;
+        usb->receive([&g, &i, &sink](const int16_t sample) {
+            if (g.contains(i++)) sink(sample);
+        });
+    }
+
+    /**
+     * Displayed window of a streamed A-scan in Q16.16 sample positions. Matches the
+     * float chain, which spans [tlim, tlim^2/(init_res/200)] in time units.
+     */
+    static void streamWindow(const uint16_t init_res,
+                             fx::q16_t& min,
+                             fx::q16_t& max) {
+        const uint32_t den = (uint32_t) cfg::sampRate() * (init_res < 200 ? 1 : init_res/200);
+        const uint64_t end = den == 0 ? 0 :
+                ((uint64_t) (init_res-1) * cfg::numPtsGlobal() << fx::Q16_SHIFT) / den;
+        min = fx::toQ16(init_res-1);
+        max = end > fx::toQ16(0xFFFF) ? fx::toQ16(0xFFFF) : end;
+    }
+
+    // TODO: Optimise
+    static void receiveBScan(Image& image, // greyscale format
+                             const uint16_t n_rows = IMG_HEIGHT,
+                             const uint16_t n_cols = IMG_WIDTH,
+                             SerialStream* usb = NULL) {
+        PROFILE(ZONE_BSCAN);
+        image.fill(0);
+
+        // Column-major storage: each A-scan is processed straight into its column
+        for (uint16_t c = 0; c < n_cols && c < Image::WIDTH; c++)
+            receiveAScan(image.column(c), n_rows, usb);
     }
 };
\ No newline at end of file
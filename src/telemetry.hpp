@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.hpp"
+#include "serial_server.hpp"
+#include "util/profiler.hpp"
+#include "util/memory.hpp"
+#include "signal_processor.hpp" // scratch::arena
+
+#ifndef TELEMETRY
+#define TELEMETRY true // periodic binary status frames on the programming port (S1)
+#endif
+
+#define TELEMETRY_INTERVAL_MS 500
+#define TELEMETRY_VERSION     2
+
+// Frame delimiters; the payload is preceded by its length and followed by a checksum
+#define TELEMETRY_SYNC_0 0xA5
+#define TELEMETRY_SYNC_1 0x5A
+
+#define TELEMETRY_FLAG_PROFILING 0x01
+#define TELEMETRY_FLAG_S2        0x02
+
+/**
+ * Compact binary status frames, interleaved with any text on Serial. A frame is
+ *
+ *   0xA5 0x5A | length (1) | payload (length) | Fletcher-16 of length and payload (2)
+ *
+ * and its little endian payload holds, in order:
+ *
+ *   version (1), flags (1), sequence (2), millis (4), FPS x10 (2),
+ *   bytes received (4), NACKs sent (2), timeouts (2), free SRAM (4),
+ *   scratch arena high-water mark (4),
+ *   number of zones (1) and per prof::Zone: count (2), mean (4) and max (4) in ns,
+ *   number of config params (1) and cfg::config_ (2 each).
+ *
+ * Zone statistics cover the interval since the previous frame; the profiler is reset
+ * after each one. serial_client/telemetry.py decodes the frames.
+ */
+class Telemetry {
+
+   public:
+    static const uint8_t MAX_PAYLOAD = 26 + 1 + prof::N_ZONES*10 + 1 + cfg::N_CFG*2;
+    static const uint8_t MAX_FRAME   = 3 + MAX_PAYLOAD + 2;
+
+    static_assert(MAX_PAYLOAD <= 0xFF, "telemetry payload length must fit in one byte");
+
+    /**
+     * Sends a frame if S1 is connected. Called every TELEMETRY_INTERVAL_MS.
+     */
+    void update(const SerialStream& usb, const float fps) {
+        if (!usb.s1()) return;
+
+        len_ = 3; // payload starts after the header
+
+        uint8_t flags = 0;
+#if PROFILING
+        flags |= TELEMETRY_FLAG_PROFILING;
+#endif
+        if (usb.s2()) flags |= TELEMETRY_FLAG_S2;
+
+        put(TELEMETRY_VERSION, 1);
+        put(flags, 1);
+        put(seq_++, 2);
+        put(millis(), 4);
+        put(fps < 0 ? 0 : fps*10 > 0xFFFF ? 0xFFFF : (uint16_t) (fps*10 + 0.5), 2);
+        put(usb.bytesReceived(), 4);
+        put(usb.nacks(), 2);
+        put(usb.timeouts(), 2);
+        put(mem::freeSram(), 4);
+        put(scratch::arena.peak(), 4);
+
+        put(prof::N_ZONES, 1);
+        for (uint8_t i = 0; i < prof::N_ZONES; i++) {
+#if PROFILING
+            const prof::Stats& s = prof::stats((prof::Zone) i);
+            put(s.count > 0xFFFF ? 0xFFFF : s.count, 2);
+            put(cycles::toNs(s.mean()), 4);
+            put(cycles::toNs(s.max), 4);
+#else
+            put(0, 2);
+            put(0, 4);
+            put(0, 4);
+#endif
+        }
+#if PROFILING
+        prof::reset();
+#endif
+
+        put(cfg::N_CFG, 1);
+        for (uint8_t i = 0; i < cfg::N_CFG; i++)
+            put(cfg::config_[i], 2);
+
+        // Header and trailer
+        frame_[0] = TELEMETRY_SYNC_0;
+        frame_[1] = TELEMETRY_SYNC_1;
+        frame_[2] = len_ - 3;
+        put(checksum(frame_ + 2, len_ - 2), 2);
+
+        Serial.write(frame_, len_);
+    }
+
+    // Fletcher-16 over n bytes
+    static uint16_t checksum(const uint8_t* data, const uint8_t n) {
+        uint16_t a = 0, b = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            a = (a + data[i]) % 0xFF;
+            b = (b + a) % 0xFF;
+        }
+        return (b << 8) | a;
+    }
+
+   private:
+    uint16_t seq_  = 0;
+    uint8_t  len_  = 0;
+    uint8_t  frame_[MAX_FRAME];
+
+    // Appends the n low bytes of v, least significant first
+    void put(const uint32_t v, const uint8_t n) {
+        for (uint8_t i = 0; i < n; i++)
+            frame_[len_++] = v >> (8*i);
+    }
+};
\ No newline at end of file
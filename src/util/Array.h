@@ -1,11 +1,8 @@
 #pragma once
 
-#ifdef ARDUINO
-#include <Arduino.h>
-#else
-#include <cstddef>
-#endif
+#include <Arduino.h> // Print; shimmed in native/ for host builds
 #include "Array/ArrayIterator.h"
+#include "Array/ArraySpan.h"
 
 template <typename T, size_t MAX_SIZE>
 class Array {
@@ -50,6 +47,8 @@ class Array {
     typedef ArrayIterator<const T> const_iterator;
     const_iterator begin() const;
     const_iterator end() const;
+    ArraySpan<T> span();
+    ArrayView<T> view() const;
 
    private:
     T values_[MAX_SIZE];
@@ -186,4 +186,14 @@ typename Array<T, MAX_SIZE>::const_iterator Array<T, MAX_SIZE>::begin() const {
 template <typename T, size_t MAX_SIZE>
 typename Array<T, MAX_SIZE>::const_iterator Array<T, MAX_SIZE>::end() const {
     return const_iterator(values_, size_);
+}
+
+template <typename T, size_t MAX_SIZE>
+ArraySpan<T> Array<T, MAX_SIZE>::span() {
+    return ArraySpan<T>(values_, size_);
+}
+
+template <typename T, size_t MAX_SIZE>
+ArrayView<T> Array<T, MAX_SIZE>::view() const {
+    return ArrayView<T>(values_, size_);
 }
\ No newline at end of file
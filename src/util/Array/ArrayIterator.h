@@ -3,9 +3,12 @@
 template <typename T>
 class ArrayIterator {
    public:
-    ArrayIterator(T* values_ptr) : values_ptr_{values_ptr}, position_{0} {}
+    ArrayIterator(T* values_ptr) : values_ptr_{values_ptr}, position_{0}, stride_{1} {}
 
-    ArrayIterator(T* values_ptr, size_t size) : values_ptr_{values_ptr}, position_{size} {}
+    ArrayIterator(T* values_ptr, size_t size) : values_ptr_{values_ptr}, position_{size}, stride_{1} {}
+
+    ArrayIterator(T* values_ptr, size_t position, size_t stride) :
+        values_ptr_{values_ptr}, position_{position}, stride_{stride} {}
 
     bool operator!=(const ArrayIterator<T>& other) const { return !(*this == other); }
 
@@ -16,9 +19,10 @@ class ArrayIterator {
         return *this;
     }
 
-    T& operator*() const { return *(values_ptr_ + position_); }
+    T& operator*() const { return *(values_ptr_ + position_ * stride_); }
 
    private:
     T* values_ptr_;
     size_t position_;
+    size_t stride_;
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+template <typename T, size_t MAX_SIZE>
+class Array;
+
+namespace array_traits {
+    template <typename T> struct remove_const          { typedef T type; };
+    template <typename T> struct remove_const<const T> { typedef T type; };
+}
+
+/**
+ * Non-owning window onto contiguous storage, e.g. an Array or a sub-range of one.
+ * Elements are addressed with a stride, so every n-th element (such as one row of
+ * a column-major image) can be viewed without copying. The referenced storage must
+ * outlive the span. Use ArrayView<T> for read-only access.
+ */
+template <typename T>
+class ArraySpan {
+   public:
+    typedef typename array_traits::remove_const<T>::type value_type;
+
+    ArraySpan() : values_ptr_{nullptr}, size_{0}, stride_{1} {}
+
+    ArraySpan(T* values_ptr, size_t size, size_t stride = 1) :
+        values_ptr_{values_ptr}, size_{size}, stride_{stride} {}
+
+    template <size_t N>
+    ArraySpan(Array<value_type, N>& array) :
+        values_ptr_{array.data()}, size_{array.size()}, stride_{1} {}
+
+    template <size_t N>
+    ArraySpan(const Array<value_type, N>& array) :
+        values_ptr_{array.data()}, size_{array.size()}, stride_{1} {}
+
+    // allow spans to be passed on as read-only views
+    ArraySpan(const ArraySpan<value_type>& span) :
+        values_ptr_{span.data()}, size_{span.size()}, stride_{span.stride()} {}
+
+    T& operator[](size_t index) const { return values_ptr_[index * stride_]; }
+    T& at(size_t index) const { return values_ptr_[index * stride_]; }
+    T& front() const { return values_ptr_[0]; }
+    T& back() const { return values_ptr_[(size_ - 1) * stride_]; }
+    size_t size() const { return size_; }
+    size_t stride() const { return stride_; }
+    bool empty() const { return size_ == 0; }
+    T* data() const { return values_ptr_; }
+
+    /**
+     * Sub-range of count elements starting at offset, bounded by the span size.
+     */
+    ArraySpan subspan(size_t offset, size_t count) const {
+        if (offset > size_) offset = size_;
+        if (count > size_ - offset) count = size_ - offset;
+        return ArraySpan(values_ptr_ + offset * stride_, count, stride_);
+    }
+
+    ArraySpan first(size_t count) const { return subspan(0, count); }
+    ArraySpan last(size_t count) const { return subspan(count < size_ ? size_ - count : 0, count); }
+
+    /**
+     * Every step-th element of the span, starting with the first.
+     */
+    ArraySpan strided(size_t step) const {
+        return ArraySpan(values_ptr_, step == 0 ? 0 : (size_ + step - 1) / step, stride_ * step);
+    }
+
+    void fill(const value_type& value) const {
+        for (size_t i = 0; i < size_; ++i) (*this)[i] = value;
+    }
+
+    typedef ArrayIterator<T> iterator;
+    iterator begin() const { return iterator(values_ptr_, 0, stride_); }
+    iterator end() const { return iterator(values_ptr_, size_, stride_); }
+
+   private:
+    T* values_ptr_;
+    size_t size_;
+    size_t stride_;
+};
+
+template <typename T>
+using ArrayView = ArraySpan<const T>;
+
+template <typename T>
+inline Print& operator<<(Print& stream, const ArraySpan<T>& span) {
+    stream.print("[");
+    for (size_t i = 0; i < span.size(); ++i) {
+        if (i != 0) {
+            stream.print(",");
+        }
+        stream.print(span[i]);
+    }
+    stream.print("]");
+    return stream;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <cstddef>
+#include <cstdint>
+#endif
+
+/**
+ * Fixed-capacity FIFO with O(1) push at the back and pop at either end (pop() takes the
+ * oldest, pop_back() the newest; there is no push_front), the queue counterpart of
+ * Array. Elements are indexed from the oldest. With one producer calling push() and
+ * one consumer calling pop()/front(), the two sides may run in different contexts
+ * (e.g. an interrupt handler and the main loop) without locking: the producer only
+ * writes head_ and the consumer only tail_. pop_back() and clear() move both ends and
+ * belong to single-context use.
+ *
+ * Indices run over [0, 2N) so that a full ring is told apart from an empty one for
+ * any N.
+ */
+template <typename T, size_t MAX_SIZE>
+class RingArray {
+    static_assert(MAX_SIZE > 0 && MAX_SIZE < 0x80000000ul, "ring capacity out of range");
+
+   public:
+    // Producer side: appends a value, or returns false if full
+    bool push(const T& value) {
+        const uint32_t head = head_;
+        if (count(head, tail_) == MAX_SIZE) return false;
+        values_[slot(head)] = value;
+        barrier(); // publish the value before the index
+        head_ = advance(head);
+        return true;
+    }
+
+    // Consumer side: removes the oldest value, or returns false if empty
+    bool pop(T& value) {
+        const uint32_t tail = tail_;
+        if (head_ == tail) return false;
+        value = values_[slot(tail)];
+        barrier(); // release the slot only after reading it
+        tail_ = advance(tail);
+        return true;
+    }
+
+    bool pop() {
+        T value;
+        return pop(value);
+    }
+
+    // Removes the newest value; single context only
+    bool pop_back() {
+        if (empty()) return false;
+        head_ = head_ == 0 ? 2*MAX_SIZE-1 : head_-1;
+        return true;
+    }
+
+    void clear() { tail_ = head_; }
+
+    const T& operator[](const size_t index) const { return values_[slot(wrap(tail_ + index))]; }
+    const T& front() const { return values_[slot(tail_)]; }
+    const T& back() const  { return values_[slot(head_ == 0 ? 2*MAX_SIZE-1 : head_-1)]; }
+
+    size_t size() const     { return count(head_, tail_); }
+    size_t max_size() const { return MAX_SIZE; }
+    size_t space() const    { return MAX_SIZE - size(); }
+    bool   empty() const    { return head_ == tail_; }
+    bool   full() const     { return size() == MAX_SIZE; }
+
+   private:
+    T values_[MAX_SIZE];
+    volatile uint32_t head_ = 0; // next slot to write
+    volatile uint32_t tail_ = 0; // oldest value
+
+    static uint32_t wrap(const uint32_t i)    { return i >= 2*MAX_SIZE ? i - 2*MAX_SIZE : i; }
+    static uint32_t advance(const uint32_t i) { return wrap(i + 1); }
+    static size_t   slot(const uint32_t i)    { return i >= MAX_SIZE ? i - MAX_SIZE : i; }
+
+    static size_t count(const uint32_t head, const uint32_t tail) {
+        return head >= tail ? head - tail : head + 2*MAX_SIZE - tail;
+    }
+
+    // Single core: keeping the compiler from reordering is sufficient
+    static inline void barrier() { __asm__ __volatile__("" ::: "memory"); }
+};
\ No newline at end of file
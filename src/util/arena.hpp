@@ -0,0 +1,83 @@
+#pragma once
+
+#include <new>
+#include <type_traits>
+#ifndef ARDUINO
+#include <cstdlib>
+#endif
+#include <Arduino.h>
+
+/**
+ * Static bump allocator for the per-column working buffers of the pipelines, in
+ * place of large automatic arrays whose stack depth grows with the window size.
+ * Allocation is a pointer bump; a Frame hands everything allocated in its scope back
+ * at once. Objects are never destroyed, so only trivially destructible types belong
+ * here (Array of scalars). The owner sizes BYTES from the worst case of its users
+ * through footprint() (see scratch::arena in signal_processor.hpp); running out at
+ * runtime halts.
+ */
+namespace scratch {
+
+    static const size_t ALIGN = 8;
+
+    constexpr size_t aligned(const size_t bytes) { return (bytes + ALIGN-1) & ~(ALIGN-1); }
+
+    // Arena bytes taken by one object of each type
+    template <typename... Ts>
+    constexpr size_t footprint() { return (aligned(sizeof(Ts)) + ... + 0); }
+
+    template <size_t BYTES>
+    class Arena {
+
+       public:
+        void* alloc(size_t bytes) {
+            bytes = aligned(bytes);
+            if (bytes > BYTES - used_) fail();
+            void* p = buf_ + used_;
+            used_ += bytes;
+            if (used_ > peak_) peak_ = used_;
+            return p;
+        }
+
+        template <typename T>
+        T& make() {
+            static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+            return *new (alloc(sizeof(T))) T();
+        }
+
+        size_t used() const     { return used_; }
+        size_t peak() const     { return peak_; } // high-water mark since start-up
+        size_t capacity() const { return BYTES; }
+
+        // Releases everything allocated through the arena during its lifetime
+        class Frame {
+           public:
+            explicit Frame(Arena& arena) : arena_(arena), mark_(arena.used_) {}
+            ~Frame() { arena_.used_ = mark_; }
+
+            Frame(const Frame&) = delete;
+            Frame& operator=(const Frame&) = delete;
+
+           private:
+            Arena&       arena_;
+            const size_t mark_;
+        };
+
+       private:
+        alignas(ALIGN) uint8_t buf_[BYTES];
+        size_t used_ = 0;
+        size_t peak_ = 0;
+
+        [[noreturn]] static void fail() {
+#ifdef ARDUINO
+            Serial.println(F("Scratch arena exhausted: footprint below the actual use"));
+            while (true) ;
+#else
+            abort();
+#endif
+        }
+    };
+}
+
+// Opens a frame on scratch::arena for the rest of the enclosing scope
+#define SCRATCH_FRAME() decltype(scratch::arena)::Frame scratch_frame_(scratch::arena)
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <cstdint>
+#endif
+
+// Compile-time maths for generating filter and lookup tables. These are only meant
+// to be evaluated by the compiler; names avoid the Arduino abs/round/min/max macros.
+namespace cx {
+
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double LN2 = 0.69314718055994530942;
+
+    constexpr double fabs(const double x) { return x < 0 ? -x : x; }
+
+    constexpr long lround(const double x) { return x < 0 ? (long) (x - 0.5) : (long) (x + 0.5); }
+
+    constexpr long lceil(const double x) {
+        const long i = (long) x;
+        return (double) i < x ? i + 1 : i;
+    }
+
+    constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+        while (b != 0) {
+            const uint32_t t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    // Taylor series after reduction to [-pi, pi]
+    constexpr double sin(double x) {
+        const long k = (long) (x / (2*PI));
+        x -= k * 2*PI;
+        if (x > PI)  x -= 2*PI;
+        if (x < -PI) x += 2*PI;
+
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 14; n++) {
+            term *= -x*x / ((2*n) * (2*n+1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double cos(const double x) { return sin(x + PI/2); }
+
+    // Normalised sinc: sin(pi x)/(pi x)
+    constexpr double sinc(const double x) { return x == 0 ? 1. : sin(PI*x) / (PI*x); }
+
+    // Taylor series after reduction by powers of two: e^x = 2^k e^r, |r| <= ln2/2
+    constexpr double exp(const double x) {
+        const long k = lround(x / LN2);
+        const double r = x - k*LN2;
+
+        double term = 1.;
+        double sum = 1.;
+        for (int n = 1; n < 16; n++) {
+            term *= r / n;
+            sum += term;
+        }
+        for (long i = 0; i < k; i++)  sum *= 2;
+        for (long i = 0; i > k; i--)  sum /= 2;
+        return sum;
+    }
+
+    // Blackman window over x in [-1, 1]
+    constexpr double blackman(const double x) {
+        return fabs(x) >= 1 ? 0. : 0.42 + 0.5*cos(PI*x) + 0.08*cos(2*PI*x);
+    }
+}
\ No newline at end of file
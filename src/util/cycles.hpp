@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <cstdint>
+#include <time.h>
+#endif
+
+// Fine-grained time base for benchmarking and profiling: the Cortex-M3 DWT cycle
+// counter on the Due (wraps after ~51 s at 84 MHz), monotonic nanoseconds on the
+// host (wraps after ~4.3 s). Intervals are taken as unsigned differences.
+namespace cycles {
+
+#ifdef ARDUINO
+    static const uint32_t TICKS_PER_US = F_CPU / 1000000;
+
+    // Enables the cycle counter; needed once after reset
+    inline void begin() {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    inline uint32_t now() { return DWT->CYCCNT; }
+
+    inline uint32_t toNs(const uint32_t ticks) { return (uint64_t) ticks * 1000 / TICKS_PER_US; }
+#else
+    static const uint32_t TICKS_PER_US = 1000;
+
+    inline void begin() {}
+
+    inline uint32_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint32_t) ts.tv_sec * 1000000000ul + ts.tv_nsec;
+    }
+
+    inline uint32_t toNs(const uint32_t ticks) { return ticks; }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <cstdint>
+#endif
+
+// Fixed-point helpers for the FPU-less Cortex-M3. Only 32-bit division is used on
+// the hot path; 32x32->64 multiplies map onto a single SMULL/UMULL instruction.
+namespace fx {
+
+    using q15_t = int16_t;  // signed fraction in [-1, 1), 15 fractional bits
+    using q31_t = int32_t;  // signed fraction in [-1, 1), 31 fractional bits
+    using q16_t = uint32_t; // unsigned 16.16 fixed point (positions and magnitudes)
+
+    static const uint8_t  Q15_SHIFT = 15;
+    static const uint8_t  Q16_SHIFT = 16;
+    static const q15_t    Q15_MAX   = 0x7FFF;
+    static const q16_t    Q16_ONE   = 1ul << Q16_SHIFT;
+
+    inline q16_t toQ16(const uint16_t x) { return (q16_t) x << Q16_SHIFT; }
+
+    /**
+     * Fraction num/den in Q15, requires num < den. Both operands are shifted down
+     * until the denominator fits in 16 bits so that the division stays 32-bit;
+     * the truncation may round num up to den, hence the saturation.
+     */
+    inline q15_t ratioQ15(uint32_t num, uint32_t den) {
+        while (den > 0xFFFF) {
+            num >>= 1;
+            den >>= 1;
+        }
+        const uint32_t t = (num << Q15_SHIFT) / den;
+        return t > (uint32_t) Q15_MAX ? Q15_MAX : (q15_t) t;
+    }
+
+    /**
+     * Quotient num/den in Q16.16, assembled from the integer quotient and the
+     * remainder so that num may use the full 32-bit range (den < 2^16).
+     */
+    inline q16_t divQ16(const uint32_t num, const uint16_t den) {
+        const uint32_t q = num / den;
+        const uint32_t r = num % den;
+        return (q << Q16_SHIFT) + (r << Q16_SHIFT) / den;
+    }
+
+    // Scale a signed value by a Q15 fraction
+    inline int32_t mulQ15(const int32_t x, const q15_t t) {
+        return (int32_t) (((int64_t) x * t) >> Q15_SHIFT);
+    }
+
+    // Linear blend a + (b-a)*t for Q16.16 magnitudes
+    inline q16_t lerpQ16(const q16_t a, const q16_t b, const q15_t t) {
+        return a + mulQ15((int32_t) (b - a), t);
+    }
+
+    // Round a Q16.16 value to the nearest integer
+    inline uint16_t roundQ16(const q16_t x) {
+        return (x + (Q16_ONE >> 1)) >> Q16_SHIFT;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+extern "C" char* sbrk(int incr);
+#else
+#include <cstdint>
+#endif
+
+namespace mem {
+
+    /**
+     * Unallocated SRAM between the top of the heap and the stack pointer: the
+     * headroom left to both. Zero on the host, where it is not meaningful.
+     */
+    inline uint32_t freeSram() {
+#ifdef ARDUINO
+        char top;
+        return &top - sbrk(0);
+#else
+        return 0;
+#endif
+    }
+}
\ No newline at end of file
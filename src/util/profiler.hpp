@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Streaming.h>
+#include "cycles.hpp"
+
+#ifndef PROFILING
+#define PROFILING true // collects per-zone timing statistics; false compiles every zone away
+#endif
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILING
+// Times the rest of the enclosing scope into the given prof::Zone
+#define PROFILE(zone) prof::Scope PROFILE_CONCAT(prof_scope_, __LINE__)(prof::zone)
+#else
+#define PROFILE(zone)
+#endif
+
+/**
+ * Zone-based profiler. A zone accumulates the duration of every Scope opened on it,
+ * measured in cycles::now() ticks, into fixed-size static storage: count, min, max,
+ * total and a log-linear histogram for percentiles. No heap is used and nothing is
+ * printed on the hot path.
+ */
+namespace prof {
+
+    enum Zone : uint8_t {
+        ZONE_LOOP,     // main tick
+        ZONE_ASCAN,    // receiveAScan, any pipeline
+        ZONE_ACQUIRE,  // serial reception or generator
+        ZONE_ENVELOPE, // demodulation: peak picking or carrier detection
+        ZONE_RESAMPLE, // resampling of the envelope onto the rows
+        ZONE_TONE_MAP, // TGC, reference tracking and greyscale lookup
+        ZONE_RENDER,   // column transfer to the display
+        ZONE_BSCAN,    // receiveBScan
+        N_ZONES
+    };
+
+    static const char* const ZONE_NAMES[N_ZONES] = {
+        "loop", "ascan", "acquire", "envelope", "resample", "tone_map", "render", "bscan"
+    };
+
+#if PROFILING
+    /**
+     * Per-zone accumulator. Histogram buckets cover [2^k, 2^(k+1)) in 2^SUB_BITS
+     * linear steps, so a percentile is resolved to within 1/2^SUB_BITS of its value.
+     */
+    struct Stats {
+        static const uint8_t  SUB_BITS  = 3;
+        static const uint8_t  SUB_N     = 1 << SUB_BITS;
+        static const uint8_t  N_BUCKETS = (32-SUB_BITS+1) * SUB_N;
+
+        uint32_t count = 0;
+        uint32_t min   = UINT32_MAX;
+        uint32_t max   = 0;
+        uint64_t total = 0;
+        uint16_t hist[N_BUCKETS] = {};
+
+        static uint8_t bucket(const uint32_t ticks) {
+            if (ticks < SUB_N) return ticks;
+            const uint8_t msb = 31 - __builtin_clz(ticks);
+            return (msb-SUB_BITS+1) * SUB_N + ((ticks >> (msb-SUB_BITS)) & (SUB_N-1));
+        }
+
+        // Largest tick count that falls into bucket b
+        static uint32_t upper(const uint8_t b) {
+            if (b < SUB_N) return b;
+            const uint8_t msb = b/SUB_N + SUB_BITS-1;
+            const uint64_t lo = (uint64_t) (SUB_N + b%SUB_N) << (msb-SUB_BITS);
+            return lo + (1ull << (msb-SUB_BITS)) - 1;
+        }
+
+        void add(const uint32_t ticks) {
+            count++;
+            total += ticks;
+            if (ticks < min) min = ticks;
+            if (ticks > max) max = ticks;
+
+            // Halve the histogram on saturation; keeps the distribution shape
+            uint16_t& h = hist[bucket(ticks)];
+            if (h == UINT16_MAX)
+                for (uint8_t i = 0; i < N_BUCKETS; i++) hist[i] >>= 1;
+            h++;
+        }
+
+        uint32_t mean() const { return count == 0 ? 0 : total / count; }
+
+        // Upper bound of the p-th percentile (0-100), clamped to the observed range
+        uint32_t percentile(const uint8_t p) const {
+            uint32_t n = 0;
+            for (uint8_t i = 0; i < N_BUCKETS; i++) n += hist[i];
+            if (n == 0) return 0;
+
+            const uint32_t target = ((uint64_t) n*p + 99) / 100;
+            uint32_t seen = 0;
+            for (uint8_t i = 0; i < N_BUCKETS; i++) {
+                seen += hist[i];
+                if (seen >= target && seen > 0) {
+                    const uint32_t v = upper(i);
+                    return v < min ? min : v > max ? max : v;
+                }
+            }
+            return max;
+        }
+
+        void reset() { *this = Stats(); }
+    };
+
+    inline Stats stats_[N_ZONES];
+
+    inline const Stats& stats(const Zone zone) { return stats_[zone]; }
+
+    inline void reset() {
+        for (uint8_t i = 0; i < N_ZONES; i++) stats_[i].reset();
+    }
+
+    // RAII zone timer, usually opened through PROFILE()
+    class Scope {
+       public:
+        explicit Scope(const Zone zone) : zone_(zone), start_(cycles::now()) {}
+        ~Scope() { stats_[zone_].add(cycles::now() - start_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        const Zone     zone_;
+        const uint32_t start_;
+    };
+
+    /**
+     * Prints every zone that has been entered, in microseconds.
+     */
+    inline void report(Print& out) {
+        out << F("zone\tcount\tmin\tmean\tp50\tp95\tp99\tmax [us]") << endl;
+        for (uint8_t i = 0; i < N_ZONES; i++) {
+            const Stats& s = stats_[i];
+            if (s.count == 0) continue;
+            out << ZONE_NAMES[i] << F("\t") << s.count;
+            const uint32_t v[] = {s.min, s.mean(), s.percentile(50), s.percentile(95),
+                                  s.percentile(99), s.max};
+            for (uint8_t j = 0; j < sizeof(v)/sizeof(v[0]); j++) {
+                out << F("\t");
+                out.print(cycles::toNs(v[j]) / 1000., 1);
+            }
+            out << endl;
+        }
+    }
+#endif
+}
\ No newline at end of file
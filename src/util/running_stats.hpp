@@ -0,0 +1,119 @@
+#pragma once
+
+#include <math.h>
+#include "RingArray.h"
+
+/**
+ * Streaming accumulators, O(1) per sample and free of heap use. Moments are kept in
+ * double: there is no FPU either way, and it keeps the add/remove updates of a
+ * sliding window from drifting over long runs.
+ */
+namespace stats {
+
+    // Exponential moving average; the first sample seeds it
+    class Ema {
+       public:
+        explicit Ema(const float alpha) : alpha_(alpha) {}
+
+        void add(const float x) {
+            value_ = primed_ ? value_ + alpha_ * (x - value_) : x;
+            primed_ = true;
+        }
+
+        float value() const { return value_; }
+        void  reset() { primed_ = false; value_ = 0; }
+
+       private:
+        float alpha_;
+        float value_  = 0;
+        bool  primed_ = false;
+    };
+
+    // Mean and variance of every sample so far (Welford's method)
+    class Welford {
+       public:
+        void add(const double x) {
+            n_++;
+            const double d = x - mean_;
+            mean_ += d / n_;
+            m2_ += d * (x - mean_);
+        }
+
+        // Undoes add(x) for a sample that is part of the set
+        void remove(const double x) {
+            if (n_ <= 1) {
+                reset();
+                return;
+            }
+            n_--;
+            const double d = x - mean_;
+            mean_ -= d / n_;
+            m2_ -= d * (x - mean_);
+            if (m2_ < 0) m2_ = 0; // rounding
+        }
+
+        uint32_t count() const    { return n_; }
+        double   mean() const     { return mean_; }
+        double   variance() const { return n_ < 2 ? 0 : m2_ / (n_-1); } // sample variance
+        double   stddev() const   { return sqrt(variance()); }
+        void     reset()          { n_ = 0; mean_ = 0; m2_ = 0; }
+
+       private:
+        uint32_t n_    = 0;
+        double   mean_ = 0;
+        double   m2_   = 0; // sum of squared deviations
+    };
+
+    /**
+     * Sum, mean, variance, minimum and maximum of the last N samples. The extremes
+     * come from monotonic wedges: candidates are dropped from the back as soon as a
+     * newer sample dominates them, so each sample is pushed and popped once.
+     */
+    template <typename T, size_t N>
+    class Window {
+       public:
+        void add(const T x) {
+            if (samples_.full()) {
+                const T old = samples_.front();
+                samples_.pop();
+                sum_ -= old;
+                moments_.remove(old);
+                if (lo_.front() == old) lo_.pop();
+                if (hi_.front() == old) hi_.pop();
+            }
+            samples_.push(x);
+            sum_ += x;
+            moments_.add(x);
+
+            while (!lo_.empty() && lo_.back() > x) lo_.pop_back();
+            lo_.push(x);
+            while (!hi_.empty() && hi_.back() < x) hi_.pop_back();
+            hi_.push(x);
+        }
+
+        size_t size() const     { return samples_.size(); }
+        bool   empty() const    { return samples_.empty(); }
+        bool   full() const     { return samples_.full(); }
+        double sum() const      { return sum_; }
+        double mean() const     { return moments_.mean(); }
+        double variance() const { return moments_.variance(); }
+        double stddev() const   { return moments_.stddev(); }
+        T      minimum() const  { return lo_.empty() ? T() : lo_.front(); }
+        T      maximum() const  { return hi_.empty() ? T() : hi_.front(); }
+
+        void reset() {
+            samples_.clear();
+            lo_.clear();
+            hi_.clear();
+            sum_ = 0;
+            moments_.reset();
+        }
+
+       private:
+        RingArray<T, N> samples_;
+        RingArray<T, N> lo_; // ascending candidates for the minimum
+        RingArray<T, N> hi_; // descending candidates for the maximum
+        double  sum_ = 0;
+        Welford moments_;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Streaming.h>
+#include "cycles.hpp"
+
+/**
+ * Cooperative scheduler over a fixed table of N tasks; nothing is allocated or
+ * preempted. A periodic task is released every period_ms. An event task is released
+ * once signal()led and at least period_ms after its previous run, which keeps it at
+ * a steady rate under bursty input. Each tick() runs every task released when it
+ * started, ordered by priority and then by the earliest release.
+ */
+template <size_t N>
+class Scheduler {
+    static_assert(N > 0 && N <= 32, "released tasks are tracked in a 32-bit mask");
+
+   public:
+    using Fn = void (*)();
+
+    enum Kind : uint8_t {
+        TASK_PERIODIC,
+        TASK_EVENT,
+    };
+
+    // Per-task run statistics; durations in cycles::now() ticks
+    struct Stats {
+        uint32_t runs     = 0;
+        uint32_t late     = 0; // periodic releases skipped because a whole period went by
+        uint32_t overruns = 0; // runs that exceeded the budget
+        uint32_t max      = 0;
+        uint64_t total    = 0;
+
+        uint32_t mean() const { return runs == 0 ? 0 : total / runs; }
+    };
+
+    /**
+     * Registers a task under id (0 to N-1). Lower priority values run first; a
+     * budget_us of 0 disables the overrun check.
+     */
+    void add(const uint8_t id,
+             const char* name,
+             Fn fn,
+             const Kind kind,
+             const uint8_t priority,
+             const uint32_t period_ms,
+             const uint32_t budget_us = 0) {
+        Task& t = tasks_[id];
+        t.name      = name;
+        t.fn        = fn;
+        t.kind      = kind;
+        t.priority  = priority;
+        t.period    = period_ms;
+        t.budget    = budget_us * cycles::TICKS_PER_US;
+        t.next      = millis();
+        t.signalled = false;
+    }
+
+    // Releases an event task; signals before its minimum spacing has passed coalesce
+    void signal(const uint8_t id) { tasks_[id].signalled = true; }
+
+    void tick() {
+        const uint32_t now = millis();
+        uint32_t pending = 0;
+        for (uint8_t i = 0; i < N; i++)
+            if (released(tasks_[i], now)) pending |= 1ul << i;
+
+        while (pending != 0) {
+            uint8_t best = N;
+            for (uint8_t i = 0; i < N; i++) {
+                if (!(pending & (1ul << i))) continue;
+                if (best == N || before(tasks_[i], tasks_[best])) best = i;
+            }
+            pending &= ~(1ul << best);
+            run(tasks_[best]);
+        }
+    }
+
+    const Stats& stats(const uint8_t id) const { return tasks_[id].stats; }
+
+    void reset() {
+        for (uint8_t i = 0; i < N; i++) tasks_[i].stats = Stats();
+    }
+
+    /**
+     * Prints the statistics of every task that has run, in microseconds.
+     */
+    void report(Print& out) const {
+        out << F("task\truns\tlate\tover\tmean\tmax [us]") << endl;
+        for (uint8_t i = 0; i < N; i++) {
+            const Task& t = tasks_[i];
+            if (t.fn == NULL || t.stats.runs == 0) continue;
+            out << t.name << F("\t") << t.stats.runs << F("\t") << t.stats.late
+                << F("\t") << t.stats.overruns << F("\t");
+            out.print(cycles::toNs(t.stats.mean()) / 1000., 1);
+            out << F("\t");
+            out.print(cycles::toNs(t.stats.max) / 1000., 1);
+            out << endl;
+        }
+    }
+
+   private:
+    struct Task {
+        const char* name = NULL;
+        Fn       fn        = NULL;
+        Kind     kind      = TASK_PERIODIC;
+        uint8_t  priority  = 0;
+        bool     signalled = false;
+        uint32_t period    = 0; // ms
+        uint32_t budget    = 0; // ticks
+        uint32_t next      = 0; // earliest release, ms
+        Stats    stats;
+    };
+
+    Task tasks_[N];
+
+    static bool due(const Task& t, const uint32_t now) { return (int32_t) (now - t.next) >= 0; }
+
+    static bool released(const Task& t, const uint32_t now) {
+        if (t.fn == NULL || !due(t, now)) return false;
+        return t.kind == TASK_PERIODIC || t.signalled;
+    }
+
+    static bool before(const Task& a, const Task& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        return (int32_t) (a.next - b.next) < 0;
+    }
+
+    void run(Task& t) {
+        // Schedule the next release first, so that the task may signal itself again
+        const uint32_t now = millis();
+        if (t.kind == TASK_EVENT || t.period == 0) {
+            t.next = now + t.period;
+        } else {
+            t.next += t.period;
+            if (due(t, now)) { // fell a whole period behind: skip rather than burst
+                t.stats.late++;
+                t.next = now + t.period;
+            }
+        }
+        t.signalled = false;
+
+        const uint32_t start = cycles::now();
+        t.fn();
+        const uint32_t ticks = cycles::now() - start;
+
+        t.stats.runs++;
+        t.stats.total += ticks;
+        if (ticks > t.stats.max) t.stats.max = ticks;
+        if (t.budget > 0 && ticks > t.budget) t.stats.overruns++;
+    }
+};
\ No newline at end of file
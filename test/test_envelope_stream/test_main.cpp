@@ -0,0 +1,68 @@
+// Host-side checks of the streaming envelope stage and the brightness mapping behind
+// PIPELINE_FUSED.
+//
+// Usage: pio test -e native -f test_envelope_stream
+
+#include <unity.h>
+#include "../../src/dsp/envelope_stream.hpp"
+#include "../../src/dsp/tone_map.hpp"
+
+static const uint16_t ROWS = 16;
+static const uint16_t LIM  = 0x7FFF;
+
+static EnvelopeStream<ROWS> stage;
+static ToneMap<ROWS>        tone;
+static Array<uint8_t, ROWS> column;
+
+// Runs one A-scan of n samples through the stage and the tone map, as receiveAScanFused()
+static void scan(const int16_t* samples, const uint16_t n) {
+    stage.begin(ROWS, 0, fx::toQ16(n > 0 ? n-1 : 0), LIM);
+    for (uint16_t i = 0; i < n; i++)
+        stage.push(samples[i]);
+    column.assign(ROWS, 0xAA); // neither black nor white
+    tone.map(stage.finish().view(), column.span());
+}
+
+void setUp() {
+    tone.configure(ROWS);
+}
+
+void tearDown() {}
+
+// The brightest row of an echo sets the reference and maps to white
+void test_echo_maps_to_white() {
+    const int16_t echo[] = {0, 100, 2500, 5000, 2500, 100, 0, 0};
+    scan(echo, sizeof(echo) / sizeof(echo[0]));
+    TEST_ASSERT_EQUAL_UINT16(ROWS, column.size());
+    uint8_t brightest = 0;
+    for (uint16_t i = 1; i < ROWS; i++)
+        if (column[i] > brightest) brightest = column[i];
+    TEST_ASSERT_EQUAL_UINT8(0xFF, brightest);
+}
+
+// A column without samples (e.g. nothing buffered on the native port) is black, not
+// the last peak of the previous A-scan repeated over every row
+void test_empty_column_maps_to_black() {
+    const int16_t echo[] = {0, 100, 2500, 5000, 2500, 100, 4000, 4000};
+    scan(echo, sizeof(echo) / sizeof(echo[0]));
+    scan(NULL, 0);
+    TEST_ASSERT_EQUAL_UINT16(ROWS, column.size());
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, &column[0], ROWS);
+}
+
+// A flat zero A-scan after an echo is black as well
+void test_zero_column_maps_to_black() {
+    const int16_t echo[] = {0, 100, 2500, 5000, 2500, 100, 0, 0};
+    const int16_t zeros[8] = {};
+    scan(echo, sizeof(echo) / sizeof(echo[0]));
+    scan(zeros, sizeof(zeros) / sizeof(zeros[0]));
+    TEST_ASSERT_EACH_EQUAL_UINT8(0, &column[0], ROWS);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_echo_maps_to_white);
+    RUN_TEST(test_empty_column_maps_to_black);
+    RUN_TEST(test_zero_column_maps_to_black);
+    return UNITY_END();
+}
\ No newline at end of file
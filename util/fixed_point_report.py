@@ -0,0 +1,67 @@
+"""
+Host-side accuracy report for the A-scan pipelines: runs the firmware's own
+SignalProcessor::receiveAScanWith through the host-native build (native/native_main.cpp,
+--dump) for a reference and a candidate pipeline (PIPELINE_FLOAT and PIPELINE_FIXED by
+default) on the same generated A-scans and compares the columns pixel by pixel.
+
+Usage: pio run -e native && python fixed_point_report.py [--cols 112] [--gain 10] [--seed S]
+                                                         [--decay 6] [--pipelines 0 1]
+"""
+
+import argparse
+import os
+import subprocess
+
+ROOT = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+# Indices into cfg::config_ (src/config.hpp)
+CFG_GAIN = 6
+CFG_REF_DECAY = 12
+
+def dump(args, pipeline):
+    """Greyscale columns of --cols A-scans processed by a pipeline, one bytes object per column."""
+    cmd = [args.program, "--dump", str(pipeline), str(args.cols),
+           "--cfg", f"{CFG_GAIN}={args.gain}", "--cfg", f"{CFG_REF_DECAY}={args.decay}"]
+    if args.seed is not None: cmd += ["--seed", str(args.seed)]
+    out = subprocess.run(cmd, capture_output=True, check=True).stdout
+    rows = len(out) // args.cols
+    return [out[c*rows:(c+1)*rows] for c in range(args.cols)]
+
+def main():
+    parser = argparse.ArgumentParser(description="Pixel accuracy of one A-scan pipeline against another")
+    parser.add_argument("--program", default=os.path.join(ROOT, ".pio", "build", "native", "program"),
+                        help="host-native firmware build")
+    parser.add_argument("--cols", type=int, default=112, help="number of A-scans to compare")
+    parser.add_argument("--gain", type=int, default=10, help="cfg::gain()")
+    parser.add_argument("--seed", type=int, help="generator seed (GEN_SEED by default)")
+    parser.add_argument("--decay", type=int, default=6, help="cfg::refDecay()")
+    parser.add_argument("--pipelines", type=int, nargs=2, default=[0, 1], metavar=("REF", "CAND"),
+                        help="PIPELINE_* ids of the reference and the compared pipeline")
+    args = parser.parse_args()
+
+    # each run draws the same A-scans from the generator and keeps its own brightness state
+    ref_cols, cand_cols = (dump(args, p) for p in args.pipelines)
+    hist = {}
+    worst_col, worst_err = 0, 0
+    sum_err = 0
+
+    for c, (ref, cand) in enumerate(zip(ref_cols, cand_cols)):
+        for a, b in zip(ref, cand):
+            err = abs(a-b)
+            hist[err] = hist.get(err, 0) + 1
+            sum_err += err
+            if err > worst_err:
+                worst_col, worst_err = c, err
+
+    rows = len(ref_cols[0]) if ref_cols else 0
+    n = max(args.cols*rows, 1)
+    print(f"Compared pipeline {args.pipelines[1]} against {args.pipelines[0]}: "
+          f"{args.cols} A-scans x {rows} rows ({args.cols*rows} pixels), gain {args.gain}")
+    print(f"  bit-exact pixels: {100*hist.get(0, 0)/n:.2f}%")
+    print(f"  mean abs error:   {sum_err/n:.4f} LSB")
+    print(f"  max abs error:    {worst_err} LSB (column {worst_col})")
+    print("  error histogram [LSB: pixels]:")
+    for err in sorted(hist):
+        print(f"    {err:3d}: {hist[err]}")
+
+if __name__ == "__main__": main()
\ No newline at end of file